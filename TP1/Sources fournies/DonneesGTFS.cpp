@@ -4,6 +4,7 @@
 //
 
 #include "DonneesGTFS.h"
+#include "trace.h"
 
 using namespace std;
 
@@ -13,7 +14,8 @@ using namespace std;
 //! \param[in] p_now2: l'heure de fin de l'intervalle considéré
 //! \brief Ces deux heures définissent l'intervalle de temps du GTFS; seuls les moments de [p_now1, p_now2) sont considérés
 DonneesGTFS::DonneesGTFS(const Date &p_date, const Heure &p_now1, const Heure &p_now2)
-        : m_date(p_date), m_now1(p_now1), m_now2(p_now2), m_nbArrets(0), m_tousLesArretsPresents(false) {
+        : m_date(p_date), m_now1(p_now1), m_now2(p_now2), m_nbArrets(0), m_tousLesArretsPresents(false),
+          m_arene(make_shared<Arene>()), m_numerotationSommets(make_shared<unsigned int>(0)) {
 }
 
 //! \brief partitionne un string en un vecteur de strings
@@ -34,6 +36,7 @@ vector<string> DonneesGTFS::string_to_vector(const string &s, char delim) {
 //! \param[in] p_nomFichier: le nom du fichier contenant les lignes
 //! \throws logic_error si un problème survient avec la lecture du fichier
 void DonneesGTFS::ajouterLignes(const std::string &p_nomFichier) {
+    Trace::Intervalle intervalle("DonneesGTFS::ajouterLignes", "chargement");
     // Ouverture du fichier
     ifstream fichier(p_nomFichier, ios::in);
     string ligneFich;
@@ -65,6 +68,7 @@ void DonneesGTFS::ajouterLignes(const std::string &p_nomFichier) {
 //! \param[in] p_nomFichier: le nom du fichier contenant les station
 //! \throws logic_error si un problème survient avec la lecture du fichier
 void DonneesGTFS::ajouterStations(const std::string &p_nomFichier) {
+    Trace::Intervalle intervalle("DonneesGTFS::ajouterStations", "chargement");
     // Ouverture du fichier
     ifstream fichier(p_nomFichier, ios::in);
     string ligneFich;
@@ -84,7 +88,8 @@ void DonneesGTFS::ajouterStations(const std::string &p_nomFichier) {
 
         // Insérer les éléments dans les containers. Les valeurs requises sont passées comme dans la définition du constructeur
         m_stations.insert({stoul(stationVect[0]), Station(stoul(stationVect[0]), stationVect[1], stationVect[2],
-                                                          Coordonnees(stod(stationVect[3]), stod(stationVect[4])))});
+                                                          Coordonnees(stod(stationVect[3]), stod(stationVect[4])),
+                                                          m_arene)});
 
     }
 
@@ -99,40 +104,41 @@ void DonneesGTFS::ajouterStations(const std::string &p_nomFichier) {
 //! \throws logic_error si un problème survient avec la lecture du fichier
 //! \throws logic_error si tous les arrets de la date et de l'intervalle n'ont pas été ajoutés
 void DonneesGTFS::ajouterTransferts(const std::string &p_nomFichier) {
-    if (m_tousLesArretsPresents) {
-        // Ouverture du fichier
-        ifstream fichier(p_nomFichier, ios::in);
-        string ligneFich;
+    Trace::Intervalle intervalle("DonneesGTFS::ajouterTransferts", "chargement");
+    // Les transferts ne sont gardés qu'entre stations desservies: il faut donc avoir ajouté les arrêts d'abord
+    if (!m_tousLesArretsPresents) {
+        throw logic_error("Les arrets de la date/intervalle n'ont pas été ajoutés!");
+    }
 
-        if (!fichier.is_open()) {
-            throw logic_error("Erreur d'ouverture du fichier");
-        }
-        if (m_tousLesArretsPresents) {
-            throw logic_error("Les arrets de la date/intervalle n'ont pas été ajoutés!");
-        }
+    // Ouverture du fichier
+    ifstream fichier(p_nomFichier, ios::in);
+    string ligneFich;
+
+    if (!fichier.is_open()) {
+        throw logic_error("Erreur d'ouverture du fichier");
+    }
 
-        getline(fichier, ligneFich); // Lire la 1ere ligne d'entête et l'enlever
+    getline(fichier, ligneFich); // Lire la 1ere ligne d'entête et l'enlever
 
-        while (getline(fichier, ligneFich)) {
-            // Découper le string dans un vecteur
-            vector<string> transfertVect = string_to_vector(ligneFich, ',');
-            if (transfertVect[0] == transfertVect[1]) {
-                continue;
-            }
-            if ((m_stations.find(stoul(transfertVect[0])) != m_stations.end()) and
-                (m_stations.find(stoul(transfertVect[1])) != m_stations.end())) {
-                if (transfertVect[3] == "0\r") {
-                    // Cette vérification permet de remplacer les 0s par des 1s; Le \r est le caractère de fin de ligne du fichier qui est présent à chaque fin de ligne
-                    transfertVect[3] = "1";
-                }
-                // Insérer les éléments dans les containers. Les valeurs requises sont passées comme dans la définition du constructeur
-                m_transferts.push_back(
-                        make_tuple(stoul(transfertVect[0]), stoul(transfertVect[1]), stoul(transfertVect[3])));
+    while (getline(fichier, ligneFich)) {
+        // Découper le string dans un vecteur
+        vector<string> transfertVect = string_to_vector(ligneFich, ',');
+        if (transfertVect[0] == transfertVect[1]) {
+            continue;
+        }
+        if ((m_stations.find(stoul(transfertVect[0])) != m_stations.end()) and
+            (m_stations.find(stoul(transfertVect[1])) != m_stations.end())) {
+            if (transfertVect[3] == "0\r") {
+                // Cette vérification permet de remplacer les 0s par des 1s; Le \r est le caractère de fin de ligne du fichier qui est présent à chaque fin de ligne
+                transfertVect[3] = "1";
             }
+            // Insérer les éléments dans les containers. Les valeurs requises sont passées comme dans la définition du constructeur
+            m_transferts.push_back(
+                    make_tuple(stoul(transfertVect[0]), stoul(transfertVect[1]), stoul(transfertVect[3])));
         }
-
-        fichier.close();
     }
+
+    fichier.close();
 }
 
 
@@ -140,6 +146,7 @@ void DonneesGTFS::ajouterTransferts(const std::string &p_nomFichier) {
 //! \param[in] p_nomFichier: le nom du fichier contenant les services
 //! \throws logic_error si un problème survient avec la lecture du fichier
 void DonneesGTFS::ajouterServices(const std::string &p_nomFichier) {
+    Trace::Intervalle intervalle("DonneesGTFS::ajouterServices", "chargement");
     // Ouverture du fichier
     ifstream fichier(p_nomFichier, ios::in);
     string ligneFich;
@@ -177,6 +184,7 @@ void DonneesGTFS::ajouterServices(const std::string &p_nomFichier) {
 //! \param[in] p_nomFichier: le nom du fichier contenant les voyages
 //! \throws logic_error si un problème survient avec la lecture du fichier
 void DonneesGTFS::ajouterVoyagesDeLaDate(const std::string &p_nomFichier) {
+    Trace::Intervalle intervalle("DonneesGTFS::ajouterVoyagesDeLaDate", "chargement");
     // Ouverture du fichier
     ifstream fichier(p_nomFichier, ios::in);
     string ligneFich;
@@ -196,7 +204,8 @@ void DonneesGTFS::ajouterVoyagesDeLaDate(const std::string &p_nomFichier) {
 
         // Ajouter les voyages (avec les paramètres requis par le constructeur de la classe) s'il y a un service pour la date
         if (m_services.find(tripsVect[1]) != m_services.end()) {
-            m_voyages.insert({tripsVect[2], Voyage(tripsVect[2], stoul(tripsVect[0]), tripsVect[1], tripsVect[3])});
+            m_voyages.insert({tripsVect[2], Voyage(tripsVect[2], stoul(tripsVect[0]), tripsVect[1], tripsVect[3],
+                                                      m_arene)});
         }
     }
 
@@ -206,10 +215,12 @@ void DonneesGTFS::ajouterVoyagesDeLaDate(const std::string &p_nomFichier) {
 //! \brief ajoute les arrets aux voyages présents dans le GTFS si l'heure du voyage appartient à l'intervalle de temps du GTFS
 //! \brief De plus, on enlève les voyages qui n'ont pas d'arrêts dans l'intervalle de temps du GTFS
 //! \brief De plus, on enlève les stations qui n'ont pas d'arrets dans l'intervalle de temps du GTFS
+//! \brief Les objets Arret et les noeuds des m_arrets des voyages et des stations sont alloués dans m_arene
 //! \param[in] p_nomFichier: le nom du fichier contenant les arrets
 //! \post assigne m_tousLesArretsPresents à true
 //! \throws logic_error si un problème survient avec la lecture du fichier
 void DonneesGTFS::ajouterArretsDesVoyagesDeLaDate(const std::string &p_nomFichier) {
+    Trace::Intervalle intervalle("DonneesGTFS::ajouterArretsDesVoyagesDeLaDate", "chargement");
     // Ouverture du fichier
     ifstream fichier(p_nomFichier, ios::in);
     string ligneFich;
@@ -236,8 +247,8 @@ void DonneesGTFS::ajouterArretsDesVoyagesDeLaDate(const std::string &p_nomFichie
 
             // Vérification des heures du trajet et ajout dans voyages et stations. Incrémentation du nombre d'arret
             if (m_now1 <= heureDepart and heureArrive < m_now2) {
-                Arret::Ptr a_ptr = make_shared<Arret>(stoul(stopVect[3]), heureArrive, heureDepart, stoul(stopVect[4]),
-                                                      stopVect[0]);
+                Arret::Ptr a_ptr = allocate_shared<Arret>(AllocateurArene<Arret>(m_arene), stoul(stopVect[3]),
+                                                          heureArrive, heureDepart, stoul(stopVect[4]), stopVect[0]);
 
                 m_voyages[stopVect[0]].ajouterArret(a_ptr);
                 m_stations[stoul(stopVect[3])].addArret(a_ptr);
@@ -276,6 +287,90 @@ void DonneesGTFS::ajouterArretsDesVoyagesDeLaDate(const std::string &p_nomFichie
     m_tousLesArretsPresents = true;
 }
 
+//! \brief applique un lot de retards (trip_id, stop_sequence, retard en secondes) aux arrets présents
+//! \brief comme en GTFS-realtime, le retard d'un arret s'applique aussi aux arrets suivants du voyage jusqu'au
+//! \brief prochain retard donné pour ce voyage; les arrets qui précèdent le premier retard donné ne changent pas
+//! \brief les lignes dont le voyage n'est pas présent dans l'objet GTFS sont ignorées
+//! \param[in] p_nomFichier: le nom du fichier contenant les retards
+//! \param[out] p_arretsModifies: les arrets dont les heures ont changé (pour ReseauGTFS::appliquerRetards)
+//! \throws logic_error si un problème survient avec la lecture du fichier
+//! \throws logic_error si un voyage retardé deviendrait incohérent (un départ après l'arrivée suivante);
+//! \brief dans ce cas, aucun retard du lot n'est appliqué
+void DonneesGTFS::appliquerRetards(const std::string &p_nomFichier, std::vector<Arret::Ptr> &p_arretsModifies) {
+    // Ouverture du fichier
+    ifstream fichier(p_nomFichier, ios::in);
+    string ligneFich;
+
+    if (!fichier.is_open()) {
+        throw logic_error("Erreur d'ouverture du fichier");
+    }
+
+    getline(fichier, ligneFich); // Lire la 1ere ligne d'entête et l'enlever
+
+    // Les retards de chaque voyage, par numéro de séquence
+    map<string, map<unsigned int, int> > retardsParVoyage;
+    while (getline(fichier, ligneFich)) {
+        // Enlever les " " de la chaine du string
+        ligneFich.erase(remove(ligneFich.begin(), ligneFich.end(), '\"'), ligneFich.end());
+
+        // Découper le string dans un vecteur
+        vector<string> retardVect = string_to_vector(ligneFich, ',');
+        if (retardVect.size() < 3 or m_voyages.find(retardVect[0]) == m_voyages.end()) {
+            continue;
+        }
+        retardsParVoyage[retardVect[0]][stoul(retardVect[1])] = stoi(retardVect[2]);
+    }
+
+    fichier.close();
+
+    // Calcul du nouveau retard de chaque arret et validation de tous les voyages avant de modifier quoi que ce soit
+    const Heure minuit(0, 0, 0);
+    vector<pair<Arret::Ptr, int> > nouveauxRetards;
+    for (const auto &voyageRetards : retardsParVoyage) {
+        const map<unsigned int, int> &retards = voyageRetards.second;
+        int departPrecedent = -1;
+        for (const Arret::Ptr &arret : m_voyages.at(voyageRetards.first).getArrets()) {
+            int retard = arret->getRetard();
+            auto itr = retards.upper_bound(arret->getNumeroSequence());
+            if (itr != retards.begin()) {
+                retard = (--itr)->second;
+            }
+            int arrivee = (arret->getHeureArrivee() - minuit) - arret->getRetard() + retard;
+            int depart = (arret->getHeureDepart() - minuit) - arret->getRetard() + retard;
+            if (arrivee < 0 or arrivee < departPrecedent) {
+                throw logic_error("DonneesGTFS::appliquerRetards(): le voyage " + voyageRetards.first +
+                                  " deviendrait incohérent");
+            }
+            departPrecedent = depart;
+            if (retard != arret->getRetard()) {
+                nouveauxRetards.push_back({arret, retard});
+            }
+        }
+    }
+
+    // La clé d'un arret dans sa station est son heure d'arrivée: on l'en retire et on l'y remet
+    for (const auto &arretRetard : nouveauxRetards) {
+        Station &station = m_stations.at(arretRetard.first->getStationId());
+        station.retirerArret(arretRetard.first);
+        arretRetard.first->appliquerRetard(arretRetard.second);
+        station.addArret(arretRetard.first);
+        p_arretsModifies.push_back(arretRetard.first);
+    }
+}
+
+//! \brief réserve une nouvelle numérotation des sommets des arrets, avant que ReseauGTFS ne les numérote
+//! \brief Le sommet de chaque arret est rangé dans l'Arret même: un réseau dont la numérotation n'est plus celle en
+//! \brief vigueur (voir getNumerotationSommets()) ne peut plus se fier aux sommets des arrets.
+//! \return la nouvelle numérotation, désormais celle en vigueur
+unsigned int DonneesGTFS::nouvelleNumerotationSommets() const {
+    return ++*m_numerotationSommets;
+}
+
+//! \brief retourne la numérotation en vigueur des sommets des arrets (0 si aucun réseau ne les a encore numérotés)
+unsigned int DonneesGTFS::getNumerotationSommets() const {
+    return *m_numerotationSommets;
+}
+
 unsigned int DonneesGTFS::getNbArrets() const {
     return m_nbArrets;
 }
@@ -402,5 +497,74 @@ const std::unordered_map<unsigned int, Ligne> &DonneesGTFS::getLignes() const {
     return m_lignes;
 }
 
+//! \brief dresse le bilan mémoire des conteneurs de l'objet GTFS, un poste par conteneur
+//! \brief chaque poste compte les noeuds (ou le tableau) du conteneur et ce que ses clés et ses éléments allouent
+//! \brief (chaînes), mais pas les conteneurs imbriqués, qui ont leur propre poste: les m_arrets de chaque station et de
+//! \brief chaque voyage. Les objets Arret, partagés par une station et un voyage, forment un poste à part.
+//! \brief La taille des noeuds est mesurée par un AllocateurCompteur (voir octetsParNoeud())
+//! \param[out] p_bilan: les postes du bilan
+void DonneesGTFS::bilanMemoire(std::vector<PosteMemoire> &p_bilan) const {
+    p_bilan.clear();
+    p_bilan.push_back({"DonneesGTFS (objet)", 1, sizeof(DonneesGTFS)});
+
+    size_t octets = octetsTable(m_lignes, octetsParNoeud(m_lignes));
+    for (const auto &ligne : m_lignes)
+        octets += octetsChaine(ligne.second.getNumero()) + octetsChaine(ligne.second.getDescription());
+    p_bilan.push_back({"m_lignes", m_lignes.size(), octets});
+
+    octets = octetsArbre(m_lignes_par_numero, octetsParNoeud(m_lignes_par_numero));
+    for (const auto &ligne : m_lignes_par_numero)
+        octets += octetsChaine(ligne.first) + octetsChaine(ligne.second.getNumero()) +
+                  octetsChaine(ligne.second.getDescription());
+    p_bilan.push_back({"m_lignes_par_numero", m_lignes_par_numero.size(), octets});
+
+    octets = octetsArbre(m_stations, octetsParNoeud(m_stations));
+    size_t octetsArretsStations = 0, nbArretsStations = 0, octetsParNoeudArret = 0;
+    for (const auto &station : m_stations) {
+        const Station::Arrets &arrets = station.second.getArrets();
+        octets += octetsChaine(station.second.getNom()) + octetsChaine(station.second.getDescription());
+        if (octetsParNoeudArret == 0) octetsParNoeudArret = octetsParNoeud(arrets);
+        octetsArretsStations += octetsArbre(arrets, octetsParNoeudArret);
+        nbArretsStations += arrets.size();
+    }
+    p_bilan.push_back({"m_stations", m_stations.size(), octets});
+    p_bilan.push_back({"m_stations[].m_arrets", nbArretsStations, octetsArretsStations});
+
+    octets = octetsArbre(m_voyages, octetsParNoeud(m_voyages));
+    size_t octetsArretsVoyages = 0, nbArretsVoyages = 0, octetsObjetsArrets = 0, octetsParArret = 0;
+    octetsParNoeudArret = 0;
+    for (const auto &voyage : m_voyages) {
+        const Voyage::Arrets &arrets = voyage.second.getArrets();
+        octets += octetsChaine(voyage.first) + octetsChaine(voyage.second.getId()) +
+                  octetsChaine(voyage.second.getServiceId()) + octetsChaine(voyage.second.getDestination());
+        if (octetsParNoeudArret == 0) octetsParNoeudArret = octetsParNoeud(arrets);
+        octetsArretsVoyages += octetsArbre(arrets, octetsParNoeudArret);
+        nbArretsVoyages += arrets.size();
+
+        //chaque arret appartient à un seul voyage: on compte ici son bloc allocate_shared (compteur de références + Arret)
+        for (const auto &arret : arrets) {
+            if (octetsParArret == 0) {
+                CompteurAllocations compteur;
+                auto copie = allocate_shared<Arret>(AllocateurCompteur<Arret>(compteur), *arret);
+                octetsParArret = compteur.octets;
+            }
+            octetsObjetsArrets += octetsParArret + octetsChaine(arret->getVoyageId());
+        }
+    }
+    p_bilan.push_back({"m_voyages", m_voyages.size(), octets});
+    p_bilan.push_back({"m_voyages[].m_arrets", nbArretsVoyages, octetsArretsVoyages});
+    p_bilan.push_back({"Arret (objets partagés)", nbArretsVoyages, octetsObjetsArrets});
+
+    octets = octetsTable(m_services, octetsParNoeud(m_services));
+    for (const auto &service : m_services) octets += octetsChaine(service);
+    p_bilan.push_back({"m_services", m_services.size(), octets});
+
+    p_bilan.push_back({"m_transferts", m_transferts.size(), octetsVecteur(m_transferts)});
+
+    //les postes précédents comptent déjà ce qui est distribué par l'arène: il ne reste que la fin de ses blocs
+    p_bilan.push_back({"m_arene (réservé, non distribué)", m_arene->getNbBlocs(),
+                       m_arene->getOctetsReserves() - min(m_arene->getOctetsReserves(), m_arene->getOctetsUtilises())});
+}
+
 
 
@@ -0,0 +1,91 @@
+//
+// Arène d'allocation par blocs et allocateur qui y puise (données GTFS chargées, listes d'adjacence du graphe)
+//
+
+#include "arene.h"
+#include <cstdint>
+#include <cstring>
+#include <new>
+
+using namespace std;
+
+//! \param[in] p_tailleBloc: la taille des blocs réservés; une demande de plus du quart d'un bloc a son propre bloc
+Arene::Arene(size_t p_tailleBloc)
+        : m_tailleBloc(p_tailleBloc), m_courant(nullptr), m_fin(nullptr), m_octetsReserves(0), m_octetsUtilises(0),
+          m_aDesRecycles(false) {
+}
+
+Arene::~Arene() {
+    for (char *bloc : m_blocs) ::operator delete(bloc);
+}
+
+//! \brief retourne p_octets octets alignés sur p_alignement (une puissance de 2 au plus alignof(max_align_t))
+//! \brief Un objet recyclé de même taille et de même alignement est réutilisé avant toute nouvelle mémoire.
+//! \throws bad_alloc lorsque la mémoire est épuisée
+void *Arene::allouer(size_t p_octets, size_t p_alignement) {
+    if (p_octets < sizeof(void *)) p_octets = sizeof(void *); //un objet recyclé contient l'adresse du suivant
+    if (m_aDesRecycles.load(memory_order_acquire)) {
+        void *objet = reprendreRecycle(p_octets, p_alignement);
+        if (objet != nullptr) return objet;
+    }
+
+    m_octetsUtilises += p_octets;
+
+    if (p_octets > m_tailleBloc / 4) {
+        //bloc dédié: le bloc courant reste utilisable pour les petites demandes
+        m_blocs.reserve(m_blocs.size() + 1);
+        char *bloc = static_cast<char *>(::operator new(p_octets));
+        m_blocs.push_back(bloc);
+        m_octetsReserves += p_octets;
+        return bloc;
+    }
+
+    uintptr_t adresse = (reinterpret_cast<uintptr_t>(m_courant) + p_alignement - 1) & ~uintptr_t(p_alignement - 1);
+    if (m_courant == nullptr || adresse + p_octets > reinterpret_cast<uintptr_t>(m_fin)) {
+        m_blocs.reserve(m_blocs.size() + 1);
+        char *bloc = static_cast<char *>(::operator new(m_tailleBloc)); //aligné pour tout type fondamental
+        m_blocs.push_back(bloc);
+        m_octetsReserves += m_tailleBloc;
+        m_fin = bloc + m_tailleBloc;
+        adresse = reinterpret_cast<uintptr_t>(bloc);
+    }
+    m_courant = reinterpret_cast<char *>(adresse + p_octets);
+    return reinterpret_cast<void *>(adresse);
+}
+
+//! \brief rend p_objet, obtenu de allouer(p_octets, p_alignement), pour la prochaine demande de même taille
+void Arene::recycler(void *p_objet, size_t p_octets, size_t p_alignement) {
+    if (p_octets < sizeof(void *)) p_octets = sizeof(void *);
+    lock_guard<mutex> verrou(m_mutexRecycles);
+    void *&tete = m_recycles[{p_octets, p_alignement}];
+    memcpy(p_objet, &tete, sizeof(void *));
+    tete = p_objet;
+    m_aDesRecycles.store(true, memory_order_release);
+}
+
+//! \brief retire de m_recycles un objet rendu de p_octets octets et d'alignement p_alignement
+//! \return l'objet, ou nullptr s'il n'y en a aucun
+void *Arene::reprendreRecycle(size_t p_octets, size_t p_alignement) {
+    lock_guard<mutex> verrou(m_mutexRecycles);
+    auto recycles = m_recycles.find({p_octets, p_alignement});
+    if (recycles == m_recycles.end()) return nullptr;
+    void *objet = recycles->second;
+    memcpy(&recycles->second, objet, sizeof(void *)); //l'objet n'est peut-être pas aligné pour un pointeur
+    if (recycles->second == nullptr) m_recycles.erase(recycles);
+    if (m_recycles.empty()) m_aDesRecycles.store(false, memory_order_release);
+    return objet;
+}
+
+//! \brief retourne les octets des blocs réservés
+size_t Arene::getOctetsReserves() const {
+    return m_octetsReserves;
+}
+
+//! \brief retourne les octets distribués (sans le remplissage d'alignement), y compris ceux des objets recyclés
+size_t Arene::getOctetsUtilises() const {
+    return m_octetsUtilises;
+}
+
+size_t Arene::getNbBlocs() const {
+    return m_blocs.size();
+}
@@ -4,6 +4,8 @@
 //
 
 #include "arret.h"
+#include <limits>
+#include <stdexcept>
 
 /*!
  *  \brief Constructeur de la classe Arret
@@ -31,7 +33,8 @@
 Arret::Arret(unsigned int p_station_id, const Heure &p_heure_arrivee, const Heure &p_heure_depart,
              unsigned int p_numero_sequence, const std::string &p_voyage_id)
         : m_station_id(p_station_id), m_heure_arrivee(p_heure_arrivee), m_heure_depart(p_heure_depart),
-          m_numero_sequence(p_numero_sequence), m_voyage_id(p_voyage_id)
+          m_numero_sequence(p_numero_sequence), m_voyage_id(p_voyage_id),
+          m_sommet(std::numeric_limits<size_t>::max()), m_retard(0)
 {
 }
 
@@ -110,3 +113,49 @@ std::string Arret::getVoyageId() const
     return m_voyage_id;
 }
 
+
+/*!
+ * \brief Accesseur de l'attribut m_sommet
+ * \return Le numéro de sommet attribué à l'arret (numeric_limits<size_t>::max() si aucun numéro n'a été attribué)
+ */
+size_t Arret::getSommet() const
+{
+    return m_sommet;
+}
+
+/*!
+ * \brief Mutateur de l'attribut m_sommet: attribue à l'arret son numéro de sommet dans le graphe espace-temps
+ * \param[in] p_sommet: le numéro de sommet
+ */
+void Arret::setSommet(size_t p_sommet)
+{
+    m_sommet = p_sommet;
+}
+
+/*!
+ * \brief Accesseur de l'attribut m_retard
+ * \return Le retard, en secondes (négatif pour une avance), par rapport à l'horaire prévu
+ */
+int Arret::getRetard() const
+{
+    return m_retard;
+}
+
+/*!
+ * \brief Remplace le retard de l'arret par rapport à l'horaire prévu: les heures d'arrivée et de départ deviennent
+ * \brief les heures prévues décalées de p_retard secondes
+ * \param[in] p_retard: le nouveau retard, en secondes (négatif pour une avance)
+ * \throws logic_error si l'heure d'arrivée résultante est avant minuit
+ * \attention si l'arret est dans une Station, il faut l'en retirer avant et l'y remettre après (la clé est l'heure d'arrivée)
+ */
+void Arret::appliquerRetard(int p_retard)
+{
+    const Heure minuit(0, 0, 0);
+    int arrivee = (m_heure_arrivee - minuit) - m_retard + p_retard;
+    int depart = (m_heure_depart - minuit) - m_retard + p_retard;
+    if (arrivee < 0 || depart < 0)
+        throw std::logic_error("Arret::appliquerRetard(): l'arret serait avant minuit");
+    m_heure_arrivee = minuit.add_secondes(arrivee);
+    m_heure_depart = minuit.add_secondes(depart);
+    m_retard = p_retard;
+}
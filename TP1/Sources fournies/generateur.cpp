@@ -0,0 +1,380 @@
+//
+// Générateur déterministe de données GTFS synthétiques, au format de RTC-8aout-1dec, à une échelle donnée
+//
+
+#include <iostream>
+#include <fstream>
+#include <sstream>
+#include <string>
+#include <vector>
+#include <random>
+#include <algorithm>
+#include <cmath>
+#include <cstdlib>
+#include <stdexcept>
+#include <sys/stat.h>
+
+using namespace std;
+
+namespace {
+
+//! \brief à l'échelle 1, ordres de grandeur de RTC-8aout-1dec: environ 4 600 stations desservies, 4 000 voyages et
+//! \brief 150 000 arrêts un jour de semaine, 700 transferts; le territoire, les lignes et les pôles d'échange sont
+//! \brief multipliés par l'échelle, la longueur des lignes et les fréquences restent celles d'une ville
+const unsigned int COTE_GRILLE = 80; //côté du territoire, en îlots, à l'échelle 1
+const unsigned int NB_LIGNES = 115;
+const unsigned int NB_POLES = 8; //pôles d'échange: la plupart des lignes y ont un terminus, on y correspond
+const double ILOT_METRES = 300; //distance entre deux arrêts consécutifs d'une ligne régulière
+const double LATITUDE_CENTRE = 46.81;
+const double LONGITUDE_CENTRE = -71.28;
+const double METRES_PAR_DEGRE = 111320;
+
+const unsigned int PREMIER_ID_LIGNE = 900000;
+const unsigned int PREMIER_ID_STATION = 1000;
+
+const int DATE_DEBUT[3] = {2017, 8, 8}; //comme RTC-8aout-1dec
+const int DATE_FIN[3] = {2017, 12, 1};
+
+enum Categorie { MetroBus, Reguliere, Express };
+enum TypeJour { Semaine, Samedi, Dimanche };
+const char *const SERVICES[] = {"GEN-1111100", "GEN-0000010", "GEN-0000001"};
+const char *const COULEURS[] = {"97BF0D", "013888", "E04503"}; //voir Ligne::couleurToCategorie()
+
+//! \brief un tracé de ligne: les îlots desservis, du terminus 0 au terminus 1, à raison d'un arrêt par îlot (un sur
+//! \brief deux pour un Métrobus)
+struct Ligne
+{
+    unsigned int id;
+    Categorie categorie;
+    vector<unsigned int> ilots;
+};
+
+//! \brief tirages reproductibles: seule la suite produite par mt19937 est fixée par la norme, pas celle des
+//! \brief distributions de <random>; on les refait donc ici pour qu'une graine donne le même réseau partout
+class Tirage
+{
+public:
+    explicit Tirage(unsigned int p_graine) : m_moteur(p_graine) {}
+
+    //! \return un entier de [0, p_n)
+    unsigned int entier(unsigned int p_n) { return (unsigned int) (m_moteur() % p_n); }
+
+    //! \return un entier de [p_min, p_max]
+    unsigned int entre(unsigned int p_min, unsigned int p_max) { return p_min + entier(p_max - p_min + 1); }
+
+    //! \return un réel de [0, 1)
+    double reel() { return m_moteur() / 4294967296.0; }
+
+private:
+    mt19937 m_moteur;
+};
+
+//! \brief identifiant d'une station: chaque îlot a deux arrêts, un de chaque côté de la rue; on s'arrête du côté 0
+//! \brief en allant vers l'est ou le nord, du côté 1 en allant vers l'ouest ou le sud
+unsigned int idStation(unsigned int p_ilot, unsigned int p_cote) {
+    return PREMIER_ID_STATION + 2 * p_ilot + p_cote;
+}
+
+//! \brief nom d'un arrêt: l'intersection de sa rue et de son avenue (sans virgule: les fichiers sont lus sans
+//! \brief tenir compte des guillemets)
+string nomStation(unsigned int p_ilot, unsigned int p_largeur) {
+    ostringstream nom;
+    nom << "Rue " << p_ilot / p_largeur + 1 << " / Avenue " << p_ilot % p_largeur + 1;
+    return nom.str();
+}
+
+string heure(unsigned int p_secondes) {
+    char texte[16];
+    snprintf(texte, sizeof(texte), "%02u:%02u:%02u", p_secondes / 3600, p_secondes / 60 % 60, p_secondes % 60);
+    return texte;
+}
+
+//! \return le jour de la semaine, 0 pour dimanche (Sakamoto)
+int jourDeLaSemaine(int p_annee, int p_mois, int p_jour) {
+    static const int decalages[] = {0, 3, 2, 5, 0, 3, 5, 1, 4, 6, 2, 4};
+    if (p_mois < 3) p_annee -= 1;
+    return (p_annee + p_annee / 4 - p_annee / 100 + p_annee / 400 + decalages[p_mois - 1] + p_jour) % 7;
+}
+
+int joursDansLeMois(int p_annee, int p_mois) {
+    static const int jours[] = {31, 28, 31, 30, 31, 30, 31, 31, 30, 31, 30, 31};
+    bool bissextile = (p_annee % 4 == 0 and p_annee % 100 != 0) or p_annee % 400 == 0;
+    return p_mois == 2 and bissextile ? 29 : jours[p_mois - 1];
+}
+
+bool enPointe(unsigned int p_secondes) {
+    return (p_secondes >= 6 * 3600 + 1800 and p_secondes < 9 * 3600) or
+           (p_secondes >= 15 * 3600 + 1800 and p_secondes < 18 * 3600 + 1800);
+}
+
+//! \return l'intervalle, en secondes, entre deux départs d'une ligne à l'heure p_secondes (0 s'il n'y a pas de
+//! \brief service à cette heure)
+unsigned int intervalle(Categorie p_categorie, TypeJour p_jour, unsigned int p_secondes) {
+    if (p_jour != Semaine) {
+        if (p_categorie == Express or p_secondes < 6 * 3600 + 1800 or p_secondes >= 24 * 3600) return 0;
+        unsigned int base = p_categorie == MetroBus ? 15 * 60 : 45 * 60;
+        return p_jour == Samedi ? base * 5 / 4 : base * 3 / 2;
+    }
+    if (p_secondes < 5 * 3600 + 1800 or p_secondes >= 24 * 3600 + 1800) return 0;
+    if (p_categorie == Express) return enPointe(p_secondes) ? 30 * 60 : 0;
+    if (p_categorie == MetroBus)
+        return enPointe(p_secondes) ? 10 * 60 : p_secondes >= 18 * 3600 + 1800 ? 30 * 60 : 15 * 60;
+    return enPointe(p_secondes) ? 30 * 60 : 60 * 60;
+}
+
+//! \brief trace une ligne en escalier d'un terminus à l'autre, à la manière d'une rue qui suit la grille
+Ligne tracerLigne(unsigned int p_id, Categorie p_categorie, unsigned int p_depart, unsigned int p_largeur,
+                  const vector<unsigned int> &p_poles, Tirage &p_tirage) {
+    Ligne ligne;
+    ligne.id = p_id;
+    ligne.categorie = p_categorie;
+
+    //les lignes express et la plupart des autres partent d'un pôle d'échange
+    unsigned int depart = p_categorie == Express or p_tirage.entier(10) < 7 ? p_poles[p_tirage.entier(p_poles.size())]
+                                                                            : p_depart;
+    unsigned int nbArrets = p_categorie == MetroBus ? p_tirage.entre(25, 40) : p_categorie == Express
+                                                                                ? p_tirage.entre(20, 35)
+                                                                                : p_tirage.entre(30, 50);
+    unsigned int pas = p_categorie == MetroBus ? 2 : 1;
+    double longueur = nbArrets * pas;
+    int x0 = depart % p_largeur, y0 = depart / p_largeur;
+    int x1 = x0, y1 = y0;
+    for (unsigned int essai = 0; essai < 8; ++essai) {
+        //une direction au hasard, en évitant si possible que la ligne soit écourtée par le bord du territoire
+        double angle = p_tirage.reel() * 2 * M_PI;
+        double norme = fabs(cos(angle)) + fabs(sin(angle));
+        x1 = int(lround(x0 + longueur * cos(angle) / norme));
+        y1 = int(lround(y0 + longueur * sin(angle) / norme));
+        if (x1 >= 0 and x1 < int(p_largeur) and y1 >= 0 and y1 < int(p_largeur)) break;
+    }
+    x1 = min(max(x1, 0), int(p_largeur) - 1);
+    y1 = min(max(y1, 0), int(p_largeur) - 1);
+
+    int x = x0, y = y0;
+    unsigned int nbPas = 0;
+    ligne.ilots.push_back(y * p_largeur + x);
+    while (x != x1 or y != y1) {
+        int dx = x1 - x, dy = y1 - y;
+        if (p_tirage.entier(abs(dx) + abs(dy)) < (unsigned int) abs(dx)) x += dx > 0 ? 1 : -1;
+        else y += dy > 0 ? 1 : -1;
+        if (++nbPas % pas == 0 or (x == x1 and y == y1)) ligne.ilots.push_back(y * p_largeur + x);
+    }
+    return ligne;
+}
+
+//! \brief côté de la rue où l'on s'arrête à l'arrêt p_k d'une suite d'îlots parcourue dans l'ordre
+unsigned int coteDeRue(const vector<unsigned int> &p_ilots, size_t p_k) {
+    if (p_ilots.size() < 2) return 0;
+    return p_k + 1 < p_ilots.size() ? (p_ilots[p_k + 1] > p_ilots[p_k] ? 0 : 1)
+                                    : (p_ilots[p_k] > p_ilots[p_k - 1] ? 0 : 1);
+}
+
+//! \brief distance en mètres entre deux îlots, le long de la grille
+double distance(unsigned int p_a, unsigned int p_b, unsigned int p_largeur) {
+    return ILOT_METRES * (abs(int(p_a % p_largeur) - int(p_b % p_largeur)) +
+                          abs(int(p_a / p_largeur) - int(p_b / p_largeur)));
+}
+
+ofstream ouvrir(const string &p_dossier, const string &p_fichier) {
+    ofstream fichier(p_dossier + "/" + p_fichier);
+    if (!fichier) throw logic_error("ouvrir(): impossible de créer " + p_dossier + "/" + p_fichier);
+    return fichier;
+}
+
+}
+
+//! \brief usage: generateur dossier_sortie [echelle] [graine]
+//! \brief Écrit dans dossier_sortie (créé au besoin) routes.txt, stops.txt, calendar_dates.txt, trips.txt,
+//! \brief stop_times.txt et transfers.txt, aux mêmes colonnes que RTC-8aout-1dec, pour la même période (2017-08-08 au
+//! \brief 2017-12-01). À l'échelle 1 (par défaut), le réseau a la taille de celui du RTC; à l'échelle 10, 100 ou 1000,
+//! \brief le territoire, les stations, les lignes, les voyages et les transferts sont multipliés d'autant. Le réseau
+//! \brief est une grille d'îlots parcourue par trois sortes de lignes: Métrobus (fréquents, un arrêt sur deux),
+//! \brief régulières et express (heures de pointe seulement, vers le pôle d'échange le matin et en revenant le soir),
+//! \brief la plupart partant d'un pôle d'échange où des transferts sont définis; les fréquences varient selon l'heure
+//! \brief (pointe, jour, soir) et le jour (semaine, samedi, dimanche). Une même graine (1 par défaut) et une même
+//! \brief échelle donnent toujours les mêmes fichiers.
+int main(int argc, char *argv[])
+{
+    if (argc < 2)
+    {
+        cerr << "usage: " << argv[0] << " dossier_sortie [echelle] [graine]" << endl;
+        return 1;
+    }
+    const string dossier = argv[1];
+    const unsigned int echelle = argc > 2 ? (unsigned int) atoi(argv[2]) : 1;
+    const unsigned int graine = argc > 3 ? (unsigned int) atoi(argv[3]) : 1;
+    if (echelle == 0) throw logic_error("main(): l'échelle doit être un entier positif");
+    mkdir(dossier.c_str(), 0777);
+
+    Tirage tirage(graine);
+    const unsigned int largeur = (unsigned int) lround(COTE_GRILLE * sqrt(double(echelle)));
+    const unsigned int nbIlots = largeur * largeur;
+
+    vector<unsigned int> poles;
+    for (unsigned int p = 0; p < NB_POLES * echelle; ++p) poles.push_back(tirage.entier(nbIlots));
+
+    vector<Ligne> lignes;
+    for (unsigned int l = 0; l < NB_LIGNES * echelle; ++l)
+    {
+        unsigned int tirageCategorie = tirage.entier(20);
+        Categorie categorie = tirageCategorie == 0 ? MetroBus : tirageCategorie < 10 ? Reguliere : Express;
+        lignes.push_back(tracerLigne(PREMIER_ID_LIGNE + l, categorie, tirage.entier(nbIlots), largeur, poles, tirage));
+    }
+
+    //stations desservies: les arrêts de chaque tracé, dans les deux sens
+    vector<bool> desservie(2 * nbIlots, false);
+    for (const Ligne &ligne : lignes)
+    {
+        vector<unsigned int> inverse(ligne.ilots.rbegin(), ligne.ilots.rend());
+        for (size_t k = 0; k < ligne.ilots.size(); ++k)
+        {
+            desservie[2 * ligne.ilots[k] + coteDeRue(ligne.ilots, k)] = true;
+            desservie[2 * inverse[k] + coteDeRue(inverse, k)] = true;
+        }
+    }
+
+    ofstream routes = ouvrir(dossier, "routes.txt");
+    routes << "route_id,agency_id,route_short_name,route_long_name,route_desc,route_type,route_url,route_color,"
+              "route_text_color\n";
+    for (const Ligne &ligne : lignes)
+        routes << ligne.id << ",GEN,\"" << ligne.id - PREMIER_ID_LIGNE + 1 << "\",,\""
+               << nomStation(ligne.ilots.front(), largeur) << " - " << nomStation(ligne.ilots.back(), largeur)
+               << "\",3,,"
+               << COULEURS[ligne.categorie] << ",000000\n";
+
+    unsigned long nbStations = 0;
+    ofstream stops = ouvrir(dossier, "stops.txt");
+    stops << "stop_id,stop_name,stop_desc,stop_lat,stop_lon,stop_url,location_type,wheelchair_boarding\n";
+    stops.setf(ios::fixed);
+    stops.precision(6);
+    for (unsigned int s = 0; s < 2 * nbIlots; ++s)
+    {
+        if (!desservie[s]) continue;
+        ++nbStations;
+        unsigned int ilot = s / 2;
+        //les arrêts s'écartent un peu du coin de l'îlot, de côtés opposés de la rue selon le sens
+        double decalage = (s % 2 ? -1 : 1) * 0.05 * ILOT_METRES;
+        double nord = (double(ilot / largeur) - largeur / 2.0) * ILOT_METRES + decalage;
+        double est = (double(ilot % largeur) - largeur / 2.0) * ILOT_METRES - decalage;
+        double latitude = LATITUDE_CENTRE + nord / METRES_PAR_DEGRE;
+        double longitude = LONGITUDE_CENTRE + est / (METRES_PAR_DEGRE * cos(latitude * M_PI / 180));
+        stops << idStation(ilot, s % 2) << ",\"" << nomStation(ilot, largeur) << "\",\"" << nomStation(ilot, largeur)
+              << (s % 2 ? " (vers l'ouest ou le sud)" : " (vers l'est ou le nord)") << "\"," << latitude << ","
+              << longitude << ",,0,2\n";
+    }
+
+    ofstream calendrier = ouvrir(dossier, "calendar_dates.txt");
+    calendrier << "service_id,date,exception_type\n";
+    for (int annee = DATE_DEBUT[0], mois = DATE_DEBUT[1], jour = DATE_DEBUT[2];;)
+    {
+        int jourSemaine = jourDeLaSemaine(annee, mois, jour);
+        TypeJour type = jourSemaine == 0 ? Dimanche : jourSemaine == 6 ? Samedi : Semaine;
+        char date[16];
+        snprintf(date, sizeof(date), "%04d%02d%02d", annee % 10000, mois % 100, jour % 100);
+        calendrier << SERVICES[type] << "," << date << ",1\n";
+        if (annee == DATE_FIN[0] and mois == DATE_FIN[1] and jour == DATE_FIN[2]) break;
+        if (++jour > joursDansLeMois(annee, mois))
+        {
+            jour = 1;
+            if (++mois > 12) mois = 1, ++annee;
+        }
+    }
+
+    unsigned long nbVoyages[3] = {0, 0, 0}, nbArrets[3] = {0, 0, 0};
+    ofstream trips = ouvrir(dossier, "trips.txt");
+    ofstream stopTimes = ouvrir(dossier, "stop_times.txt");
+    trips << "route_id,service_id,trip_id,trip_headsign,trip_short_name,direction_id,block_id,shape_id,"
+             "wheelchair_accessible\n";
+    stopTimes << "trip_id,arrival_time,departure_time,stop_id,stop_sequence,pickup_type,drop_off_type\n";
+    for (const Ligne &ligne : lignes)
+    {
+        const double vitesse = ligne.categorie == MetroBus ? 7.0 : ligne.categorie == Express ? 6.5 : 5.0; //m/s
+        const unsigned int arret = ligne.categorie == MetroBus ? 25 : 15; //secondes à chaque arrêt
+        for (unsigned int direction = 0; direction < 2; ++direction)
+        {
+            vector<unsigned int> ilots = ligne.ilots;
+            if (direction == 1) reverse(ilots.begin(), ilots.end());
+            for (unsigned int type = Semaine; type <= Dimanche; ++type)
+            {
+                //express: vers le pôle d'échange (direction 1) le matin, en revenant (direction 0) le soir
+                unsigned int t = 5 * 3600 + 1800;
+                unsigned int premier = 0;
+                while (t < 25 * 3600 and intervalle(ligne.categorie, TypeJour(type), t) == 0) t += 300;
+                if (t < 25 * 3600) premier = tirage.entier(intervalle(ligne.categorie, TypeJour(type), t));
+                for (t += premier; t < 25 * 3600;)
+                {
+                    unsigned int pas = intervalle(ligne.categorie, TypeJour(type), t);
+                    if (pas == 0)
+                    {
+                        t += 300;
+                        continue;
+                    }
+                    bool sensDeLaPointe = ligne.categorie != Express or (t < 12 * 3600) == (direction == 1);
+                    if (sensDeLaPointe)
+                    {
+                        ostringstream id;
+                        id << ligne.id << "-" << direction << "-" << t << "-" << SERVICES[type];
+                        trips << ligne.id << "," << SERVICES[type] << "," << id.str() << ",\""
+                              << nomStation(ilots.back(), largeur) << "\",," << direction << ",,"
+                              << ligne.id << direction << ",1\n";
+                        ++nbVoyages[type];
+
+                        double ralentissement = type == Semaine and enPointe(t) ? 1.25 : 1.0;
+                        double instant = t;
+                        for (size_t k = 0; k < ilots.size(); ++k)
+                        {
+                            if (k > 0)
+                                instant += ralentissement * distance(ilots[k - 1], ilots[k], largeur) / vitesse + arret;
+                            string h = heure((unsigned int) lround(instant));
+                            stopTimes << id.str() << "," << h << "," << h << ","
+                                      << idStation(ilots[k], coteDeRue(ilots, k)) << "," << k + 1 << ",0,0\n";
+                        }
+                        nbArrets[type] += ilots.size();
+                    }
+                    t += pas;
+                }
+            }
+        }
+    }
+
+    //transferts entre les arrêts desservis autour de chaque pôle d'échange (de part et d'autre de la rue et aux
+    //îlots voisins), dans les deux sens; le fichier du RTC a des fins de ligne \r\n
+    unsigned long nbTransferts = 0;
+    ofstream transfers = ouvrir(dossier, "transfers.txt");
+    transfers << "from_stop_id,to_stop_id,transfer_type,min_transfer_time\r\n";
+    vector<bool> dejaPole(nbIlots, false);
+    for (unsigned int pole : poles)
+    {
+        if (dejaPole[pole]) continue;
+        dejaPole[pole] = true;
+        vector<unsigned int> voisines;
+        int x = pole % largeur, y = pole / largeur;
+        for (int dy = -1; dy <= 1; ++dy)
+            for (int dx = -1; dx <= 1; ++dx)
+            {
+                if (dx != 0 and dy != 0) continue;
+                if (x + dx < 0 or x + dx >= int(largeur) or y + dy < 0 or y + dy >= int(largeur)) continue;
+                unsigned int ilot = (y + dy) * largeur + x + dx;
+                for (unsigned int c = 0; c < 2; ++c)
+                    if (desservie[2 * ilot + c]) voisines.push_back(2 * ilot + c);
+            }
+        for (unsigned int de : voisines)
+            for (unsigned int a : voisines)
+            {
+                if (de == a) continue;
+                unsigned int minutes = 2 + unsigned(distance(de / 2, a / 2, largeur) / ILOT_METRES);
+                transfers << idStation(de / 2, de % 2) << "," << idStation(a / 2, a % 2) << ",2," << minutes * 60
+                          << "\r\n";
+                ++nbTransferts;
+            }
+    }
+
+    cerr << "Échelle " << echelle << " (graine " << graine << "): grille de " << largeur << " x " << largeur
+         << " îlots, "
+         << lignes.size() << " lignes, " << nbStations << " stations, " << nbTransferts << " transferts" << endl;
+    static const char *const nomsJours[] = {"semaine", "samedi", "dimanche"};
+    for (unsigned int type = Semaine; type <= Dimanche; ++type)
+        cerr << "  " << nomsJours[type] << ": " << nbVoyages[type] << " voyages, " << nbArrets[type] << " arrêts"
+             << endl;
+    return 0;
+}
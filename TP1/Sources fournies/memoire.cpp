@@ -0,0 +1,33 @@
+//
+// Mesure de l'empreinte mémoire des conteneurs (allocateur compteur et octets par conteneur)
+//
+
+#include "memoire.h"
+#include <iomanip>
+
+using namespace std;
+
+//! \brief retourne les octets alloués par une chaîne en dehors de l'objet string lui-même
+//! \brief une chaîne courte est rangée dans l'objet (0 octet); sinon sa capacité plus le caractère nul est allouée
+size_t octetsChaine(const std::string &p_chaine) {
+    static const size_t capaciteInterne = string().capacity();
+    return p_chaine.capacity() > capaciteInterne ? p_chaine.capacity() + 1 : 0;
+}
+
+//! \brief retourne la somme des octets des postes de p_bilan
+size_t totalOctets(const std::vector<PosteMemoire> &p_bilan) {
+    size_t total = 0;
+    for (const auto &poste : p_bilan) total += poste.octets;
+    return total;
+}
+
+//! \brief affiche un bilan mémoire, un poste par ligne, suivi du total
+void afficherBilanMemoire(std::ostream &p_sortie, const std::vector<PosteMemoire> &p_bilan) {
+    ios::fmtflags format = p_sortie.flags();
+    for (const auto &poste : p_bilan) {
+        p_sortie << left << setw(36) << poste.nom << right << setw(12) << poste.nbElements << " éléments "
+                 << setw(14) << poste.octets << " octets" << endl;
+    }
+    p_sortie << left << setw(36) << "total" << right << setw(36) << totalOctets(p_bilan) << " octets" << endl;
+    p_sortie.flags(format);
+}
@@ -0,0 +1,174 @@
+//
+// Mesure de l'empreinte mémoire des conteneurs (allocateur compteur et octets par conteneur)
+//
+
+#ifndef RTC_MEMOIRE_H
+#define RTC_MEMOIRE_H
+
+#include <string>
+#include <vector>
+#include <map>
+#include <set>
+#include <unordered_map>
+#include <unordered_set>
+#include <memory>
+#include <ostream>
+
+/*!
+ * \struct PosteMemoire
+ * \brief Une ligne d'un bilan mémoire: une structure de données, son nombre d'éléments et les octets qu'elle occupe
+ */
+struct PosteMemoire
+{
+    std::string nom;
+    size_t nbElements;
+    size_t octets;
+};
+
+size_t totalOctets(const std::vector<PosteMemoire> &);
+void afficherBilanMemoire(std::ostream &, const std::vector<PosteMemoire> &);
+size_t octetsChaine(const std::string &);
+
+/*!
+ * \struct CompteurAllocations
+ * \brief Les octets alloués (et non libérés) par les AllocateurCompteur qui partagent ce compteur
+ */
+struct CompteurAllocations
+{
+    CompteurAllocations() : octets(0), octetsUnitaires(0) {}
+    size_t octets; //tous les octets alloués
+    size_t octetsUnitaires; //les octets des allocations d'un seul objet (les noeuds des arbres et des tables de hachage)
+};
+
+/*!
+ * \class AllocateurCompteur
+ * \brief Allocateur qui délègue à std::allocator et compte les octets alloués dans un CompteurAllocations
+ * \brief Un conteneur qui l'utilise alloue exactement comme avec std::allocator: on y mesure la taille réelle de ses
+ * \brief noeuds et de ses tableaux, quelle que soit la bibliothèque standard
+ */
+template<typename T>
+class AllocateurCompteur
+{
+public:
+    typedef T value_type;
+
+    explicit AllocateurCompteur(CompteurAllocations &p_compteur) : m_compteur(&p_compteur) {}
+    template<typename U>
+    AllocateurCompteur(const AllocateurCompteur<U> &p_autre) : m_compteur(p_autre.m_compteur) {}
+
+    T *allocate(size_t p_n)
+    {
+        m_compteur->octets += p_n * sizeof(T);
+        if (p_n == 1) m_compteur->octetsUnitaires += sizeof(T);
+        return std::allocator<T>().allocate(p_n);
+    }
+
+    void deallocate(T *p_objets, size_t p_n)
+    {
+        m_compteur->octets -= p_n * sizeof(T);
+        if (p_n == 1) m_compteur->octetsUnitaires -= sizeof(T);
+        std::allocator<T>().deallocate(p_objets, p_n);
+    }
+
+    template<typename U>
+    bool operator==(const AllocateurCompteur<U> &p_autre) const { return m_compteur == p_autre.m_compteur; }
+    template<typename U>
+    bool operator!=(const AllocateurCompteur<U> &p_autre) const { return m_compteur != p_autre.m_compteur; }
+
+private:
+    template<typename U> friend class AllocateurCompteur;
+    CompteurAllocations *m_compteur;
+};
+
+//! \brief le type Conteneur avec un AllocateurCompteur: ConteneurCompte<C>::creer() en construit un vide qui a la même
+//! \brief relation d'ordre (ou les mêmes fonctions de hachage et d'égalité) que p_modele
+template<typename Conteneur>
+struct ConteneurCompte;
+
+template<typename K, typename V, typename C, typename A>
+struct ConteneurCompte<std::map<K, V, C, A> >
+{
+    typedef std::map<K, V, C, AllocateurCompteur<std::pair<const K, V> > > type;
+    static type creer(const std::map<K, V, C, A> &p_modele, CompteurAllocations &p_compteur)
+    {
+        return type(p_modele.key_comp(), typename type::allocator_type(p_compteur));
+    }
+};
+
+template<typename K, typename V, typename C, typename A>
+struct ConteneurCompte<std::multimap<K, V, C, A> >
+{
+    typedef std::multimap<K, V, C, AllocateurCompteur<std::pair<const K, V> > > type;
+    static type creer(const std::multimap<K, V, C, A> &p_modele, CompteurAllocations &p_compteur)
+    {
+        return type(p_modele.key_comp(), typename type::allocator_type(p_compteur));
+    }
+};
+
+template<typename K, typename C, typename A>
+struct ConteneurCompte<std::set<K, C, A> >
+{
+    typedef std::set<K, C, AllocateurCompteur<K> > type;
+    static type creer(const std::set<K, C, A> &p_modele, CompteurAllocations &p_compteur)
+    {
+        return type(p_modele.key_comp(), typename type::allocator_type(p_compteur));
+    }
+};
+
+template<typename K, typename V, typename H, typename E, typename A>
+struct ConteneurCompte<std::unordered_map<K, V, H, E, A> >
+{
+    typedef std::unordered_map<K, V, H, E, AllocateurCompteur<std::pair<const K, V> > > type;
+    static type creer(const std::unordered_map<K, V, H, E, A> &p_modele, CompteurAllocations &p_compteur)
+    {
+        return type(0, p_modele.hash_function(), p_modele.key_eq(), typename type::allocator_type(p_compteur));
+    }
+};
+
+template<typename K, typename H, typename E, typename A>
+struct ConteneurCompte<std::unordered_set<K, H, E, A> >
+{
+    typedef std::unordered_set<K, H, E, AllocateurCompteur<K> > type;
+    static type creer(const std::unordered_set<K, H, E, A> &p_modele, CompteurAllocations &p_compteur)
+    {
+        return type(0, p_modele.hash_function(), p_modele.key_eq(), typename type::allocator_type(p_compteur));
+    }
+};
+
+//! \brief retourne la taille d'un noeud de p_conteneur (un arbre ou une table de hachage), mesurée en copiant un de
+//! \brief ses éléments dans un conteneur du même type muni d'un AllocateurCompteur (0 si p_conteneur est vide)
+//! \brief la taille ne dépend que du type: il suffit de la mesurer une fois par type
+template<typename Conteneur>
+size_t octetsParNoeud(const Conteneur &p_conteneur)
+{
+    if (p_conteneur.empty()) return 0;
+    CompteurAllocations compteur;
+    typename ConteneurCompte<Conteneur>::type copie = ConteneurCompte<Conteneur>::creer(p_conteneur, compteur);
+    copie.insert(*p_conteneur.begin());
+    return compteur.octetsUnitaires;
+}
+
+//! \brief octets alloués par un arbre (map, multimap, set) pour ses noeuds, dont la taille est p_octetsParNoeud
+//! \brief ce que les éléments allouent eux-mêmes (chaînes, conteneurs imbriqués) n'est pas compté
+template<typename Conteneur>
+size_t octetsArbre(const Conteneur &p_conteneur, size_t p_octetsParNoeud)
+{
+    return p_conteneur.size() * p_octetsParNoeud;
+}
+
+//! \brief octets alloués par une table de hachage pour ses noeuds et son tableau d'alvéoles
+template<typename Conteneur>
+size_t octetsTable(const Conteneur &p_conteneur, size_t p_octetsParNoeud)
+{
+    return p_conteneur.size() * p_octetsParNoeud +
+           (p_conteneur.bucket_count() > 1 ? p_conteneur.bucket_count() * sizeof(void *) : 0);
+}
+
+//! \brief octets alloués par un vecteur (sa capacité, pas seulement sa taille)
+template<typename T, typename A>
+size_t octetsVecteur(const std::vector<T, A> &p_vecteur)
+{
+    return p_vecteur.capacity() * sizeof(T);
+}
+
+#endif //RTC_MEMOIRE_H
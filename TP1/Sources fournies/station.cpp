@@ -23,11 +23,13 @@
  * 		.
  * 	.
  * Dans le cadre de ce travail, nous n’utiliserons qu’une partie de ces données ; plus précisément stop_id (m_id), stop_name(m_nom), stop_desc(m_description), stop_lat et stop_long(m_coords)
+ * \param[in] p_arene: l'arène des noeuds de m_arrets (le tas si aucune)
  *
  */
 Station::Station(unsigned int p_id, const std::string &p_nom, const std::string &p_description,
-                 const Coordonnees &p_coords) :
-        m_id(p_id), m_nom(p_nom), m_description(p_description), m_coords(p_coords)
+                 const Coordonnees &p_coords, const std::shared_ptr<Arene> &p_arene) :
+        m_id(p_id), m_nom(p_nom), m_description(p_description), m_coords(p_coords),
+        m_arrets(Arrets::allocator_type(p_arene))
 {
 
 }
@@ -75,8 +77,24 @@ void Station::addArret(const Arret::Ptr &p_arret)
     m_arrets.insert({p_arret->getHeureArrivee(), p_arret});
 }
 
+//! \brief retire un arret de la station (par exemple avant de modifier son heure d'arrivée, qui est sa clé)
+//! \throws logic_error si l'arret n'est pas dans la station
+void Station::retirerArret(const Arret::Ptr &p_arret)
+{
+    auto intervalle = m_arrets.equal_range(p_arret->getHeureArrivee());
+    for (auto itr = intervalle.first; itr != intervalle.second; ++itr)
+    {
+        if (itr->second == p_arret)
+        {
+            m_arrets.erase(itr);
+            return;
+        }
+    }
+    throw std::logic_error("Station::retirerArret(): cet arret n'est pas dans la station");
+}
+
 //! \brief retourne le conteneur m_arrets par référence constante
-const std::multimap<Heure, Arret::Ptr> &Station::getArrets() const
+const Station::Arrets &Station::getArrets() const
 {
     return m_arrets;
 }
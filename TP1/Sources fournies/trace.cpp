@@ -0,0 +1,112 @@
+//
+// Traces d'exécution au format « trace event » (JSON) de Chrome, lisibles par chrome://tracing ou Perfetto
+//
+
+#include "trace.h"
+#include "registre.h"
+#include <atomic>
+#include <mutex>
+#include <memory>
+#include <vector>
+#include <fstream>
+#include <iomanip>
+#include <stdexcept>
+
+using namespace std;
+
+namespace {
+
+//! \brief un intervalle terminé, en nanosecondes depuis le début de la trace
+struct Evenement {
+    const char *nom;
+    const char *categorie;
+    long long debut;
+    long long duree;
+};
+
+//! \brief les intervalles d'un thread; le mutex n'est disputé que pendant ecrireJson() et vider()
+struct TamponThread {
+    mutex m_mutex;
+    vector<Evenement> evenements;
+};
+
+typedef RegistreParThread<TamponThread> Tampons; //le numéro d'un tampon est celui de son thread dans la trace
+
+atomic<bool> traceActive(false);
+atomic<long long> origine(0); //le début de la trace, en nanosecondes de steady_clock
+
+long long nanosecondes(chrono::steady_clock::time_point p_instant) {
+    return chrono::duration_cast<chrono::nanoseconds>(p_instant.time_since_epoch()).count();
+}
+
+}
+
+Trace::Intervalle::Intervalle(const char *p_nom, const char *p_categorie)
+        : m_nom(traceActive.load(memory_order_relaxed) ? p_nom : nullptr), m_categorie(p_categorie) {
+    if (m_nom) m_debut = chrono::steady_clock::now();
+}
+
+Trace::Intervalle::~Intervalle() {
+    if (!m_nom) return;
+    long long debut = nanosecondes(m_debut);
+    long long fin = nanosecondes(chrono::steady_clock::now());
+    TamponThread &tampon = Tampons::duThread();
+    lock_guard<mutex> verrou(tampon.m_mutex);
+    tampon.evenements.push_back({m_nom, m_categorie, debut - origine.load(memory_order_relaxed), fin - debut});
+}
+
+//! \brief active la trace; les instants sont mesurés à partir de ce premier appel (ou du premier suivant vider())
+void Trace::demarrer() {
+    bool vide = true;
+    Tampons::pourChacun([&vide](size_t, TamponThread &p_tampon) {
+        lock_guard<mutex> verrouTampon(p_tampon.m_mutex);
+        vide = vide and p_tampon.evenements.empty();
+    });
+    if (vide) origine.store(nanosecondes(chrono::steady_clock::now()));
+    traceActive.store(true);
+}
+
+//! \brief désactive la trace; les intervalles déjà commencés sont tout de même enregistrés à leur fin
+void Trace::arreter() {
+    traceActive.store(false);
+}
+
+bool Trace::estActive() {
+    return traceActive.load(memory_order_relaxed);
+}
+
+//! \brief écrit l'objet JSON {"traceEvents": [...]} de tous les intervalles enregistrés (événements "X", en microsecondes)
+//! \brief chaque thread est nommé dans la trace par un événement de métadonnées "thread_name"
+void Trace::ecrireJson(std::ostream &p_sortie) {
+    ios::fmtflags format = p_sortie.flags();
+    p_sortie << fixed << setprecision(3);
+    p_sortie << "{\"displayTimeUnit\": \"ms\", \"traceEvents\": [";
+    Tampons::pourChacun([&p_sortie](size_t p_numero, TamponThread &p_tampon) {
+        lock_guard<mutex> verrouTampon(p_tampon.m_mutex);
+        p_sortie << (p_numero == 0 ? "\n" : ",\n") << "{\"name\": \"thread_name\", \"ph\": \"M\", \"pid\": 1, \"tid\": "
+                 << p_numero << ", \"args\": {\"name\": \"thread " << p_numero << "\"}}";
+        for (const Evenement &e : p_tampon.evenements) {
+            p_sortie << ",\n{\"name\": \"" << e.nom << "\", \"cat\": \"" << e.categorie << "\", \"ph\": \"X\", \"ts\": "
+                     << e.debut / 1000.0 << ", \"dur\": " << e.duree / 1000.0 << ", \"pid\": 1, \"tid\": " << p_numero
+                     << "}";
+        }
+    });
+    p_sortie << "\n]}\n";
+    p_sortie.flags(format);
+}
+
+//! \brief écrit la trace dans le fichier p_nomFichier (voir ecrireJson())
+//! \throws logic_error si le fichier ne peut être ouvert
+void Trace::ecrireFichier(const std::string &p_nomFichier) {
+    ofstream fichier(p_nomFichier);
+    if (!fichier.is_open()) throw logic_error("Trace::ecrireFichier(): impossible d'ouvrir " + p_nomFichier);
+    ecrireJson(fichier);
+}
+
+//! \brief oublie tous les intervalles enregistrés
+void Trace::vider() {
+    Tampons::pourChacun([](size_t, TamponThread &p_tampon) {
+        lock_guard<mutex> verrouTampon(p_tampon.m_mutex);
+        p_tampon.evenements.clear();
+    });
+}
@@ -11,10 +11,12 @@
  * \param[in] p_ligne_id : identificateur de la ligne desservie par le voyage
  * \param[in] p_service_id: identificateur du service auquel ce voyage appartient
  * \param[in] p_destination: destination du voyage
+ * \param[in] p_arene: l'arène des noeuds de m_arrets (le tas si aucune)
  */
 Voyage::Voyage(const std::string &p_id, unsigned int p_ligne_id, const std::string &p_service_id,
-               const std::string &p_destination) :
-        m_id(p_id), m_ligne(p_ligne_id), m_service_id(p_service_id), m_destination(p_destination)
+               const std::string &p_destination, const std::shared_ptr<Arene> &p_arene) :
+        m_id(p_id), m_ligne(p_ligne_id), m_service_id(p_service_id), m_destination(p_destination),
+        m_arrets(Arrets::allocator_type(p_arene))
 {
 }
 
@@ -23,7 +25,7 @@ Voyage::Voyage()
 }
 
 //! \brief retourne le conteneur m_arrets par référence constante
-const std::set<Arret::Ptr, Voyage::compArret> &Voyage::getArrets() const
+const Voyage::Arrets &Voyage::getArrets() const
 {
     return m_arrets;
 }
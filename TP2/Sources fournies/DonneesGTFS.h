@@ -20,6 +20,8 @@
 #include "voyage.h"
 #include "arret.h"
 #include "coordonnees.h"
+#include "memoire.h"
+#include "arene.h"
 
 class DonneesGTFS
 {
@@ -33,6 +35,7 @@ public:
     void ajouterVoyagesDeLaDate(const std::string &);
     void ajouterArretsDesVoyagesDeLaDate(const std::string&);
     void ajouterTransferts(const std::string&);
+    void appliquerRetards(const std::string &, std::vector<Arret::Ptr> &);
 
     void afficherLignes() const;
     void afficherStations() const;
@@ -52,6 +55,9 @@ public:
     const std::map<unsigned int, Station> & getStations() const;
     const std::unordered_map<unsigned int, Ligne> & getLignes() const;
     const std::vector<std::tuple<unsigned int, unsigned int, unsigned int> > & getTransferts() const;
+    void bilanMemoire(std::vector<PosteMemoire> &) const;
+    unsigned int nouvelleNumerotationSommets() const;
+    unsigned int getNumerotationSommets() const;
 
 private:
 
@@ -64,6 +70,14 @@ private:
     unsigned int m_nbArrets; //le nombre d'arrets au total présents dans cet objet
     bool m_tousLesArretsPresents; //indique si tous les arrêts de la date et de l'intervalle [now1, now2) ont été ajoutés
 
+    //les objets Arret et les noeuds des m_arrets des stations et des voyages; partagée par leurs copies (ex.: un
+    //ReseauGTFS qui garde des Arret::Ptr), elle est rendue d'un coup lorsque le dernier de ces objets est détruit
+    std::shared_ptr<Arene> m_arene;
+
+    //la numérotation en vigueur des sommets des arrets (voir Arret::setSommet()); partagée par les copies, qui partagent
+    //les arrets
+    std::shared_ptr<unsigned int> m_numerotationSommets;
+
     std::unordered_map<unsigned int, Ligne> m_lignes; //la clé unsigned int est l'identifiant m_id de l'objet Ligne
     std::map<unsigned int, Station> m_stations; //la clé unsigned int est l'identifiant m_id de l'objet Station
     std::unordered_set<std::string> m_services; //le string est l'identifiant du service (service_id)
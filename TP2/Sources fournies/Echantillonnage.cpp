@@ -0,0 +1,40 @@
+//
+// Tirage reproductible de requêtes (paires de stations, heures de départ) et percentiles des mesures, pour les bancs
+// d'essai (benchmark du TP3) et le harnais différentiel
+//
+
+#include "Echantillonnage.h"
+#include <cmath>
+
+using namespace std;
+
+//! \brief tire au hasard deux stations distinctes de p_stations dont la distance est dans [p_distanceMin, p_distanceMax)
+//! \brief Les tirages ne dépendent que de p_generateur et de p_stations: le même germe redonne les mêmes paires
+//! \return false si aucune paire n'a été trouvée en 10000 essais (la distance ne s'applique pas à ce réseau)
+bool tirerPaireDeStations(const std::vector<const Station *> &p_stations, double p_distanceMin, double p_distanceMax,
+                          std::mt19937 &p_generateur, const Station *&p_origine, const Station *&p_destination) {
+    uniform_int_distribution<size_t> station(0, p_stations.size() - 1);
+    for (unsigned int essai = 0; essai < 10000; ++essai) {
+        const Station *a = p_stations[station(p_generateur)];
+        const Station *b = p_stations[station(p_generateur)];
+        double distance = a->getCoords() - b->getCoords();
+        if (a == b or distance < p_distanceMin or distance >= p_distanceMax) continue;
+        p_origine = a;
+        p_destination = b;
+        return true;
+    }
+    return false;
+}
+
+//! \brief tire au hasard une heure de [p_secondesMin, p_secondesMax] secondes après minuit
+Heure tirerHeure(unsigned int p_secondesMin, unsigned int p_secondesMax, std::mt19937 &p_generateur) {
+    uniform_int_distribution<unsigned int> secondes(p_secondesMin, p_secondesMax);
+    return Heure(0, 0, 0).add_secondes(secondes(p_generateur));
+}
+
+//! \brief le percentile p (rang le plus proche) de valeurs triées; 0 s'il n'y en a aucune
+double percentile(const std::vector<double> &p_triees, double p) {
+    if (p_triees.empty()) return 0;
+    size_t rang = (size_t) ceil(p / 100.0 * p_triees.size());
+    return p_triees[rang == 0 ? 0 : rang - 1];
+}
@@ -0,0 +1,18 @@
+//
+// Tirage reproductible de requêtes (paires de stations, heures de départ) et percentiles des mesures, pour les bancs
+// d'essai (benchmark du TP3) et le harnais différentiel
+//
+
+#ifndef TP2_ECHANTILLONNAGE_H
+#define TP2_ECHANTILLONNAGE_H
+
+#include <vector>
+#include <random>
+#include "DonneesGTFS.h"
+
+bool tirerPaireDeStations(const std::vector<const Station *> &, double, double, std::mt19937 &, const Station *&,
+                          const Station *&);
+Heure tirerHeure(unsigned int, unsigned int, std::mt19937 &);
+double percentile(const std::vector<double> &, double);
+
+#endif //TP2_ECHANTILLONNAGE_H
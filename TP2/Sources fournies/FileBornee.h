@@ -0,0 +1,73 @@
+//
+// File bornée de tâches partagée entre un producteur et des threads travailleurs
+//
+
+#ifndef TP2_FILEBORNEE_H
+#define TP2_FILEBORNEE_H
+
+#include <deque>
+#include <mutex>
+#include <condition_variable>
+#include <utility>
+#include <chrono>
+
+//! \brief file de tâches bornée: ajouter() bloque lorsque la file est pleine, ce qui ralentit la lecture des requêtes
+//! \brief plutôt que de laisser la mémoire croître lorsque les travailleurs ne suffisent pas
+template<typename T>
+class FileBornee
+{
+public:
+    explicit FileBornee(size_t p_capacite) : m_capacite(p_capacite), m_fermee(false) {}
+
+    void ajouter(T p_element)
+    {
+        std::unique_lock<std::mutex> verrou(m_mutex);
+        m_pasPleine.wait(verrou, [this]() { return m_elements.size() < m_capacite; });
+        m_elements.push_back(std::move(p_element));
+        m_pasVide.notify_one();
+    }
+
+    //! \return false lorsque la file est fermée et vide
+    bool retirer(T &p_element)
+    {
+        std::unique_lock<std::mutex> verrou(m_mutex);
+        m_pasVide.wait(verrou, [this]() { return !m_elements.empty() or m_fermee; });
+        if (m_elements.empty()) return false;
+        p_element = std::move(m_elements.front());
+        m_elements.pop_front();
+        m_pasPleine.notify_one();
+        return true;
+    }
+
+    //! \brief comme retirer(), mais n'attend qu'au plus p_delai qu'un élément soit ajouté
+    //! \return Retire si p_element a été retiré, Vide si le délai est écoulé, Fermee lorsque la file est fermée et vide
+    enum Resultat { Retire, Vide, Fermee };
+
+    Resultat retirer(T &p_element, std::chrono::milliseconds p_delai)
+    {
+        std::unique_lock<std::mutex> verrou(m_mutex);
+        if (!m_pasVide.wait_for(verrou, p_delai, [this]() { return !m_elements.empty() or m_fermee; })) return Vide;
+        if (m_elements.empty()) return Fermee;
+        p_element = std::move(m_elements.front());
+        m_elements.pop_front();
+        m_pasPleine.notify_one();
+        return Retire;
+    }
+
+    void fermer()
+    {
+        std::lock_guard<std::mutex> verrou(m_mutex);
+        m_fermee = true;
+        m_pasVide.notify_all();
+    }
+
+private:
+    const size_t m_capacite;
+    bool m_fermee;
+    std::deque<T> m_elements;
+    std::mutex m_mutex;
+    std::condition_variable m_pasVide;
+    std::condition_variable m_pasPleine;
+};
+
+#endif //TP2_FILEBORNEE_H
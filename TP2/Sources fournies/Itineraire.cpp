@@ -0,0 +1,119 @@
+//
+// Itinéraire structuré d'une requête et ses rendus (texte, JSON), produits à la demande
+//
+
+#include "Itineraire.h"
+#include <iomanip>
+
+using namespace std;
+
+const unsigned int Itineraire::POINT_ORIGINE;
+const unsigned int Itineraire::POINT_DESTINATION;
+
+//! \brief retourne l'heure d'arrivée au point destination (l'heure de départ si l'itinéraire n'est pas Trouve)
+Heure Itineraire::getHeureArrivee() const {
+    return statut == Trouve ? heureDepart.add_secondes(duree) : heureDepart;
+}
+
+//! \brief écrit l'itinéraire en clair, une instruction par ligne
+//! \param[in] p_gtfs: les données GTFS à partir desquelles le réseau de l'itinéraire a été construit
+//! \throws out_of_range si une station, un voyage ou une ligne de l'itinéraire est absent de p_gtfs
+void Itineraire::ecrireTexte(const DonneesGTFS &p_gtfs, std::ostream &p_sortie) const {
+    if (statut == Inatteignable) {
+        p_sortie << "La destination n'est pas atteignable de l'orignine durant cet intervalle de temps\n";
+        return;
+    }
+    if (statut == SurPlace) {
+        p_sortie << "Vous êtes déjà situé à la destination demandée\n";
+        return;
+    }
+
+    p_sortie << "\n=====================\n     ITINÉRAIRE      \n=====================\n\n";
+    p_sortie << "Heure de départ du point d'origine: " << heureDepart << "\n";
+    const map<unsigned int, Station> &stations = p_gtfs.getStations();
+    for (const EtapeItineraire &etape : etapes) {
+        if (etape.mode == EtapeItineraire::Marche) {
+            if (etape.stationDepart == POINT_ORIGINE)
+                p_sortie << "Rendez vous à la station " << stations.at(etape.stationArrivee) << "\n";
+            else if (etape.stationArrivee == POINT_DESTINATION)
+                p_sortie << "Déplacez-vous à pieds de cette station au point destination\n";
+            else
+                p_sortie << "De cette station, rendez-vous à pieds à la station " << stations.at(etape.stationArrivee)
+                         << "\n";
+            continue;
+        }
+        const Voyage &voyage = p_gtfs.getVoyages().at(etape.montee->getVoyageId());
+        p_sortie << "De cette station, prenez l'autobus numéro " << p_gtfs.getLignes().at(voyage.getLigne()).getNumero()
+                 << " à l'heure " << etape.montee->getHeureArrivee() << " " << voyage << "\n";
+        p_sortie << "et arrêtez-vous à la station " << stations.at(etape.stationArrivee) << " à l'heure "
+                 << etape.descente->getHeureArrivee() << "\n";
+    }
+    p_sortie << "Heure d'arrivée à la destination: " << getHeureArrivee() << "\n";
+    p_sortie << "Durée du trajet: " << duree / 3600 << " heures, " << duree % 3600 / 60 << " minutes, " << duree % 60
+             << " secondes\n";
+}
+
+namespace {
+
+//! \brief écrit p_texte entre guillemets, en échappant ce que JSON interdit dans une chaîne
+void ecrireChaineJson(std::ostream &p_sortie, const std::string &p_texte) {
+    p_sortie << '"';
+    for (char c : p_texte) {
+        if (c == '"' or c == '\\') p_sortie << '\\' << c;
+        else if ((unsigned char) c < 0x20)
+            p_sortie << "\\u" << hex << setw(4) << setfill('0') << (int) c << dec << setfill(' ');
+        else p_sortie << c;
+    }
+    p_sortie << '"';
+}
+
+//! \brief écrit l'extrémité d'une étape: "origine", "destination" ou {"station": id, "nom": ...}
+void ecrireStationJson(std::ostream &p_sortie, const DonneesGTFS &p_gtfs, unsigned int p_station) {
+    if (p_station == Itineraire::POINT_ORIGINE) p_sortie << "\"origine\"";
+    else if (p_station == Itineraire::POINT_DESTINATION) p_sortie << "\"destination\"";
+    else {
+        p_sortie << "{\"station\": " << p_station << ", \"nom\": ";
+        ecrireChaineJson(p_sortie, p_gtfs.getStations().at(p_station).getNom());
+        p_sortie << "}";
+    }
+}
+
+}
+
+//! \brief écrit, sur une ligne, l'objet JSON {"statut", "depart", "arrivee", "duree", "etapes"} de l'itinéraire
+//! \brief une étape est {"mode": "marche", "de", "a"} ou {"mode": "autobus", "ligne", "voyage", "voyage_id",
+//! \brief "direction", "de", "a", "montee", "descente"}; "arrivee", "duree" et "etapes" sont absents si le statut
+//! \brief n'est pas "trouve"
+//! \param[in] p_gtfs: les données GTFS à partir desquelles le réseau de l'itinéraire a été construit
+//! \throws out_of_range si une station, un voyage ou une ligne de l'itinéraire est absent de p_gtfs
+void Itineraire::ecrireJson(const DonneesGTFS &p_gtfs, std::ostream &p_sortie) const {
+    static const char *const nomsStatuts[] = {"trouve", "inatteignable", "sur_place"};
+    p_sortie << "{\"statut\": \"" << nomsStatuts[statut] << "\", \"depart\": \"" << heureDepart << "\"";
+    if (statut != Trouve) {
+        p_sortie << "}";
+        return;
+    }
+    p_sortie << ", \"arrivee\": \"" << getHeureArrivee() << "\", \"duree\": " << duree << ", \"etapes\": [";
+    for (size_t k = 0; k < etapes.size(); ++k) {
+        const EtapeItineraire &etape = etapes[k];
+        p_sortie << (k ? ", " : "");
+        if (etape.mode == EtapeItineraire::Marche) {
+            p_sortie << "{\"mode\": \"marche\", \"de\": ";
+        } else {
+            const Voyage &voyage = p_gtfs.getVoyages().at(etape.montee->getVoyageId());
+            p_sortie << "{\"mode\": \"autobus\", \"ligne\": ";
+            ecrireChaineJson(p_sortie, p_gtfs.getLignes().at(voyage.getLigne()).getNumero());
+            p_sortie << ", \"voyage\": " << etape.voyage << ", \"voyage_id\": ";
+            ecrireChaineJson(p_sortie, voyage.getId());
+            p_sortie << ", \"direction\": ";
+            ecrireChaineJson(p_sortie, voyage.getDestination());
+            p_sortie << ", \"montee\": \"" << etape.montee->getHeureArrivee() << "\", \"descente\": \""
+                     << etape.descente->getHeureArrivee() << "\", \"de\": ";
+        }
+        ecrireStationJson(p_sortie, p_gtfs, etape.stationDepart);
+        p_sortie << ", \"a\": ";
+        ecrireStationJson(p_sortie, p_gtfs, etape.stationArrivee);
+        p_sortie << "}";
+    }
+    p_sortie << "]}";
+}
@@ -0,0 +1,54 @@
+//
+// Itinéraire structuré d'une requête et ses rendus (texte, JSON), produits à la demande
+//
+
+#ifndef TP2_ITINERAIRE_H
+#define TP2_ITINERAIRE_H
+
+#include <vector>
+#include <ostream>
+#include "DonneesGTFS.h"
+
+/*!
+ * \struct EtapeItineraire
+ * \brief Une étape d'un itinéraire: une marche d'une station (ou du point origine) à une autre (ou au point
+ * \brief destination), ou un trajet en autobus de l'arrêt de montée à l'arrêt de descente d'un même voyage
+ */
+struct EtapeItineraire
+{
+    enum Mode { Marche, Autobus };
+
+    Mode mode;
+    unsigned int stationDepart; //identifiant de la station de départ (Itineraire::POINT_ORIGINE pour la première marche)
+    unsigned int stationArrivee; //identifiant de la station d'arrivée (Itineraire::POINT_DESTINATION pour la dernière)
+    unsigned int voyage; //Autobus: le numéro du voyage (ordre de DonneesGTFS::getVoyages())
+    Arret::Ptr montee; //Autobus: l'arrêt où l'on monte (vide pour une marche)
+    Arret::Ptr descente; //Autobus: l'arrêt où l'on descend (vide pour une marche)
+};
+
+/*!
+ * \struct Itineraire
+ * \brief Le résultat d'une recherche d'itinéraire, reconstruit en un seul parcours du chemin dans le graphe sans
+ * \brief consulter les données GTFS; celles-ci ne servent qu'aux rendus, ecrireTexte() et ecrireJson(), appelés
+ * \brief seulement si on veut l'itinéraire sous cette forme
+ */
+struct Itineraire
+{
+    enum Statut { Trouve, Inatteignable, SurPlace };
+
+    static const unsigned int POINT_ORIGINE = 0; //la station fantôme du point origine dans ReseauGTFS
+    static const unsigned int POINT_DESTINATION = 1; //la station fantôme des points destination dans ReseauGTFS
+
+    Itineraire() : statut(Inatteignable), heureDepart(0, 0, 0), duree(0) {} //Heure() lit l'horloge avec localtime()
+
+    Statut statut;
+    Heure heureDepart; //l'heure de départ du point origine
+    unsigned int duree; //la durée du trajet, en secondes (Trouve seulement)
+    std::vector<EtapeItineraire> etapes; //dans l'ordre du trajet (Trouve seulement)
+
+    Heure getHeureArrivee() const;
+    void ecrireTexte(const DonneesGTFS &, std::ostream &) const;
+    void ecrireJson(const DonneesGTFS &, std::ostream &) const;
+};
+
+#endif //TP2_ITINERAIRE_H
@@ -0,0 +1,231 @@
+//
+// Histogrammes de latences (HDR) et mesures par phase des recherches d'itinéraires
+//
+
+#include "Mesures.h"
+#include "registre.h"
+#include <atomic>
+#include <mutex>
+#include <memory>
+#include <limits>
+#include <cmath>
+
+using namespace std;
+
+const unsigned int HistogrammeHDR::BITS_SOUS_INTERVALLES;
+const unsigned int HistogrammeHDR::BITS_VALEUR_MAX;
+const size_t HistogrammeHDR::NB_COMPTEURS;
+
+HistogrammeHDR::HistogrammeHDR()
+        : m_compteurs(NB_COMPTEURS, 0), m_nombre(0), m_somme(0), m_min(numeric_limits<uint64_t>::max()), m_max(0) {
+}
+
+//! \brief retourne le compteur de la valeur p_valeur
+//! \brief les valeurs < 128 ont chacune leur compteur; une valeur dans [2^k, 2^(k+1)) tombe dans un des 128
+//! \brief sous-intervalles de largeur 2^(k-7) de cette puissance de 2
+size_t HistogrammeHDR::indice(uint64_t p_valeur) {
+    const uint64_t nbSousIntervalles = uint64_t(1) << BITS_SOUS_INTERVALLES;
+    if (p_valeur < nbSousIntervalles) return (size_t) p_valeur;
+    unsigned int k = 63 - (unsigned int) __builtin_clzll(p_valeur); //le bit le plus significatif
+    if (k >= BITS_VALEUR_MAX) return NB_COMPTEURS - 1;
+    unsigned int decalage = k - BITS_SOUS_INTERVALLES;
+    return (size_t) (((decalage + 1) << BITS_SOUS_INTERVALLES) + ((p_valeur >> decalage) - nbSousIntervalles));
+}
+
+//! \brief retourne la plus grande valeur comptée par le compteur p_indice
+uint64_t HistogrammeHDR::valeurMaxDe(size_t p_indice) {
+    const uint64_t nbSousIntervalles = uint64_t(1) << BITS_SOUS_INTERVALLES;
+    if (p_indice < nbSousIntervalles) return p_indice;
+    unsigned int decalage = (unsigned int) (p_indice >> BITS_SOUS_INTERVALLES) - 1;
+    uint64_t sousIntervalle = p_indice & (nbSousIntervalles - 1);
+    return ((nbSousIntervalles + sousIntervalle + 1) << decalage) - 1;
+}
+
+//! \brief enregistre p_nombre fois la valeur p_valeur
+void HistogrammeHDR::enregistrer(uint64_t p_valeur, uint64_t p_nombre) {
+    if (p_nombre == 0) return;
+    m_compteurs[indice(p_valeur)] += p_nombre;
+    m_nombre += p_nombre;
+    m_somme += p_valeur * p_nombre;
+    m_min = min(m_min, p_valeur);
+    m_max = max(m_max, p_valeur);
+}
+
+//! \brief ajoute à cet histogramme toutes les valeurs de p_autre
+void HistogrammeHDR::fusionner(const HistogrammeHDR &p_autre) {
+    for (size_t i = 0; i < NB_COMPTEURS; ++i) m_compteurs[i] += p_autre.m_compteurs[i];
+    m_nombre += p_autre.m_nombre;
+    m_somme += p_autre.m_somme;
+    m_min = min(m_min, p_autre.m_min);
+    m_max = max(m_max, p_autre.m_max);
+}
+
+uint64_t HistogrammeHDR::getNombre() const {
+    return m_nombre;
+}
+
+//! \brief retourne la plus petite valeur enregistrée (0 si aucune)
+uint64_t HistogrammeHDR::getMin() const {
+    return m_nombre == 0 ? 0 : m_min;
+}
+
+uint64_t HistogrammeHDR::getMax() const {
+    return m_max;
+}
+
+double HistogrammeHDR::getMoyenne() const {
+    return m_nombre == 0 ? 0 : double(m_somme) / m_nombre;
+}
+
+//! \brief retourne la valeur au percentile p_percentile (rang le plus proche), à 1/128 près
+//! \param[in] p_percentile: dans [0, 100]
+//! \return 0 si aucune valeur n'a été enregistrée
+uint64_t HistogrammeHDR::valeurAuPercentile(double p_percentile) const {
+    if (m_nombre == 0) return 0;
+    uint64_t rang = (uint64_t) ceil(p_percentile / 100.0 * m_nombre);
+    if (rang == 0) return getMin();
+    uint64_t cumul = 0;
+    for (size_t i = 0; i < NB_COMPTEURS; ++i) {
+        cumul += m_compteurs[i];
+        if (cumul >= rang) return min(valeurMaxDe(i), m_max);
+    }
+    return m_max;
+}
+
+//! \brief écrit, sur une ligne, l'objet JSON {"nombre", "min", "p50", "p90", "p99", "p999", "max", "moyenne"}
+void HistogrammeHDR::ecrireJson(std::ostream &p_sortie) const {
+    p_sortie << "{\"nombre\": " << m_nombre << ", \"min\": " << getMin() << ", \"p50\": " << valeurAuPercentile(50)
+             << ", \"p90\": " << valeurAuPercentile(90) << ", \"p99\": " << valeurAuPercentile(99)
+             << ", \"p999\": " << valeurAuPercentile(99.9) << ", \"max\": " << m_max << ", \"moyenne\": "
+             << getMoyenne() << "}";
+}
+
+HistogrammeUnEcrivain::HistogrammeUnEcrivain() {
+    vider();
+}
+
+namespace {
+
+//! \brief ajoute p_increment à un compteur dont le thread courant est le seul écrivain (pas d'instruction verrouillée)
+inline void ajouter(atomic<uint64_t> &p_compteur, uint64_t p_increment) {
+    p_compteur.store(p_compteur.load(memory_order_relaxed) + p_increment, memory_order_relaxed);
+}
+
+}
+
+//! \brief enregistre la valeur p_valeur
+//! \pre appelée uniquement par le thread écrivain
+void HistogrammeUnEcrivain::enregistrer(uint64_t p_valeur) {
+    ajouter(m_compteurs[HistogrammeHDR::indice(p_valeur)], 1);
+    ajouter(m_nombre, 1);
+    ajouter(m_somme, p_valeur);
+    if (p_valeur < m_min.load(memory_order_relaxed)) m_min.store(p_valeur, memory_order_relaxed);
+    if (p_valeur > m_max.load(memory_order_relaxed)) m_max.store(p_valeur, memory_order_relaxed);
+}
+
+//! \brief retourne une copie des compteurs; pendant que l'écrivain enregistre, le nombre et les compteurs peuvent
+//! \brief différer des quelques dernières valeurs
+HistogrammeHDR HistogrammeUnEcrivain::lire() const {
+    HistogrammeHDR histogramme;
+    for (size_t i = 0; i < HistogrammeHDR::NB_COMPTEURS; ++i)
+        histogramme.m_compteurs[i] = m_compteurs[i].load(memory_order_relaxed);
+    histogramme.m_nombre = m_nombre.load(memory_order_relaxed);
+    histogramme.m_somme = m_somme.load(memory_order_relaxed);
+    histogramme.m_min = m_min.load(memory_order_relaxed);
+    histogramme.m_max = m_max.load(memory_order_relaxed);
+    return histogramme;
+}
+
+//! \brief remet les compteurs à zéro
+//! \pre l'écrivain n'enregistre pas en même temps (sinon certaines de ses valeurs peuvent survivre à la remise à zéro)
+void HistogrammeUnEcrivain::vider() {
+    for (auto &compteur : m_compteurs) compteur.store(0, memory_order_relaxed);
+    m_nombre.store(0, memory_order_relaxed);
+    m_somme.store(0, memory_order_relaxed);
+    m_min.store(numeric_limits<uint64_t>::max(), memory_order_relaxed);
+    m_max.store(0, memory_order_relaxed);
+}
+
+namespace {
+
+//! \brief les histogrammes d'un thread; seul ce thread y enregistre, les autres ne font que les lire
+struct CompteursThread {
+    CompteursThread() : id(this_thread::get_id()) {}
+
+    thread::id id;
+    HistogrammeUnEcrivain phases[MesuresItineraire::NbPhases];
+};
+
+typedef RegistreParThread<CompteursThread> Compteurs;
+
+const char *const nomsPhases[MesuresItineraire::NbPhases] = {"ajout_arcs", "recherche", "reconstruction", "rendu"};
+
+}
+
+//! \brief enregistre, pour le thread courant, une durée de p_nanosecondes dans la phase p_phase
+void MesuresItineraire::enregistrer(Phase p_phase, uint64_t p_nanosecondes) {
+    Compteurs::duThread().phases[p_phase].enregistrer(p_nanosecondes);
+}
+
+//! \brief retourne l'histogramme de la phase p_phase de chaque thread ayant enregistré au moins une mesure
+//! \param[out] p_threads: p_threads[k] est le thread de l'histogramme k
+std::vector<HistogrammeHDR> MesuresItineraire::parThread(Phase p_phase, std::vector<std::thread::id> &p_threads) {
+    vector<HistogrammeHDR> histogrammes;
+    p_threads.clear();
+    Compteurs::pourChacun([&](size_t, CompteursThread &p_compteurs) {
+        histogrammes.push_back(p_compteurs.phases[p_phase].lire());
+        p_threads.push_back(p_compteurs.id);
+    });
+    return histogrammes;
+}
+
+//! \brief retourne l'histogramme de la phase p_phase, tous threads confondus
+HistogrammeHDR MesuresItineraire::fusion(Phase p_phase) {
+    HistogrammeHDR histogramme;
+    Compteurs::pourChacun([&](size_t, CompteursThread &p_compteurs) {
+        histogramme.fusionner(p_compteurs.phases[p_phase].lire());
+    });
+    return histogramme;
+}
+
+//! \brief écrit, sur une ligne, l'objet JSON {"ajout_arcs": ..., "recherche": ..., "reconstruction": ..., "rendu": ...}
+//! \brief des histogrammes (en nanosecondes) de toutes les phases, tous threads confondus
+//! \param[in] p_parThread: true pour ajouter à chaque phase la liste "par_thread" des histogrammes de chaque thread
+void MesuresItineraire::ecrireJson(std::ostream &p_sortie, bool p_parThread) {
+    p_sortie << "{";
+    for (int phase = 0; phase < NbPhases; ++phase) {
+        vector<thread::id> threads;
+        vector<HistogrammeHDR> histogrammes = parThread(Phase(phase), threads);
+        HistogrammeHDR histogramme;
+        for (const auto &h : histogrammes) histogramme.fusionner(h);
+
+        p_sortie << (phase ? ", " : "") << "\"" << nomsPhases[phase] << "\": ";
+        if (!p_parThread) {
+            histogramme.ecrireJson(p_sortie);
+            continue;
+        }
+        p_sortie << "{\"tous\": ";
+        histogramme.ecrireJson(p_sortie);
+        p_sortie << ", \"par_thread\": [";
+        for (size_t k = 0; k < histogrammes.size(); ++k) {
+            p_sortie << (k ? ", " : "") << "{\"thread\": \"" << threads[k] << "\", \"histogramme\": ";
+            histogrammes[k].ecrireJson(p_sortie);
+            p_sortie << "}";
+        }
+        p_sortie << "]}";
+    }
+    p_sortie << "}";
+}
+
+//! \brief remet à zéro les histogrammes de tous les threads (ex.: après un réchauffement)
+//! \pre aucune recherche n'est en cours
+void MesuresItineraire::reinitialiser() {
+    Compteurs::pourChacun([](size_t, CompteursThread &p_compteurs) {
+        for (auto &phase : p_compteurs.phases) phase.vider();
+    });
+}
+
+//! \brief retourne le nom de la phase p_phase tel qu'écrit par ecrireJson()
+const char *MesuresItineraire::nomPhase(Phase p_phase) {
+    return nomsPhases[p_phase];
+}
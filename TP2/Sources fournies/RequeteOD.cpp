@@ -0,0 +1,118 @@
+//
+// Requêtes origine-destination en texte (serveur, traitement par lot) et leur calcul sur une copie du réseau
+//
+
+#include "RequeteOD.h"
+#include <sstream>
+#include <stdexcept>
+
+using namespace std;
+
+//! \brief découpe p_ligne aux séparateurs p_separateur (un champ vide entre deux séparateurs est conservé)
+std::vector<std::string> separerChamps(const std::string &p_ligne, char p_separateur) {
+    vector<string> champs;
+    stringstream flux(p_ligne);
+    string champ;
+    while (getline(flux, champ, p_separateur)) champs.push_back(champ);
+    return champs;
+}
+
+//! \brief lit une heure HH:MM:SS
+//! \throws logic_error si p_texte n'est pas de cette forme
+Heure lireHeure(const std::string &p_texte) {
+    if (p_texte.size() != 8 or p_texte[2] != ':' or p_texte[5] != ':')
+        throw logic_error("heure invalide (HH:MM:SS attendu): " + p_texte);
+    return Heure(stoul(p_texte.substr(0, 2)), stoul(p_texte.substr(3, 2)), stoul(p_texte.substr(6, 2)));
+}
+
+//! \brief lit une date AAAA-MM-JJ
+//! \throws logic_error si p_texte n'est pas de cette forme
+Date lireDate(const std::string &p_texte) {
+    if (p_texte.size() != 10 or p_texte[4] != '-' or p_texte[7] != '-')
+        throw logic_error("date invalide (AAAA-MM-JJ attendu): " + p_texte);
+    return Date(stoul(p_texte.substr(0, 4)), stoul(p_texte.substr(5, 2)), stoul(p_texte.substr(8, 2)));
+}
+
+//! \brief lit les six premiers champs d'une requête: lat_origine, lon_origine, lat_destination, lon_destination,
+//! \brief AAAA-MM-JJ, HH:MM:SS (les champs suivants, s'il y en a, sont laissés à l'appelant)
+//! \throws logic_error s'il y a moins de six champs ou si l'un d'eux est invalide
+RequeteOD lireRequeteOD(const std::vector<std::string> &p_champs) {
+    if (p_champs.size() < 6) throw logic_error("6 champs attendus");
+    try {
+        return RequeteOD{Coordonnees(stod(p_champs[0]), stod(p_champs[1])),
+                         Coordonnees(stod(p_champs[2]), stod(p_champs[3])), lireDate(p_champs[4]),
+                         lireHeure(p_champs[5])};
+    }
+    catch (const invalid_argument &) {
+        throw logic_error("champ non numérique");
+    }
+    catch (const out_of_range &) {
+        throw logic_error("champ numérique hors limites");
+    }
+}
+
+//! \brief vérifie que la requête porte sur les horaires chargés: la date p_date et un départ dans [p_debut, p_fin)
+//! \throws logic_error sinon
+void verifierRequeteOD(const RequeteOD &p_requete, const Date &p_date, const Heure &p_debut, const Heure &p_fin) {
+    if (!(p_requete.date == p_date)) {
+        ostringstream message;
+        message << "date non chargée: " << p_requete.date;
+        throw logic_error(message.str());
+    }
+    if (p_requete.depart < p_debut or !(p_requete.depart < p_fin))
+        throw logic_error("heure hors de l'intervalle chargé");
+}
+
+namespace {
+
+//! \brief ajoute à p_reseau l'origine de p_requete et les points p_destinations, appelle p_calcul, puis enlève les
+//! \brief points (même en cas d'exception)
+template<typename Calcul>
+auto avecPointsOD(const DonneesGTFS &p_gtfs, ReseauGTFS &p_reseau, const RequeteOD &p_requete,
+                  const std::vector<Coordonnees> &p_destinations, Calcul p_calcul) -> decltype(p_calcul()) {
+    p_reseau.ajouterArcsOrigineDestinations(p_gtfs, p_requete.origine, p_destinations, p_requete.depart);
+    try {
+        auto resultat = p_calcul();
+        p_reseau.enleverArcsOrigineDestination();
+        return resultat;
+    }
+    catch (...) {
+        p_reseau.enleverArcsOrigineDestination();
+        throw;
+    }
+}
+
+}
+
+//! \brief retourne la durée, en secondes, du trajet de p_requete (= numeric_limits<unsigned int>::max() si la
+//! \brief destination est inatteignable)
+//! \param[in,out] p_reseau: une copie du réseau propre au thread appelant; elle est rendue telle quelle
+//! \pre p_requete a été vérifiée par verifierRequeteOD() contre les horaires de p_gtfs
+unsigned int dureeRequeteOD(const DonneesGTFS &p_gtfs, ReseauGTFS &p_reseau, const RequeteOD &p_requete) {
+    return avecPointsOD(p_gtfs, p_reseau, p_requete, vector<Coordonnees>(1, p_requete.destination),
+                        [&p_reseau]() { return p_reseau.dureeItineraire(); });
+}
+
+//! \brief retourne l'itinéraire de p_requete (voir ReseauGTFS::trouverItineraire())
+//! \param[in,out] p_reseau: une copie du réseau propre au thread appelant; elle est rendue telle quelle
+//! \pre p_requete a été vérifiée par verifierRequeteOD() contre les horaires de p_gtfs
+Itineraire itineraireRequeteOD(const DonneesGTFS &p_gtfs, ReseauGTFS &p_reseau, const RequeteOD &p_requete) {
+    return avecPointsOD(p_gtfs, p_reseau, p_requete, vector<Coordonnees>(1, p_requete.destination),
+                        [&p_reseau]() { return p_reseau.trouverItineraire(); });
+}
+
+//! \brief retourne, en une seule recherche, les itinéraires de p_requete vers sa destination puis vers chacun des points
+//! \brief de p_autresDestinations, dans cet ordre (voir ReseauGTFS::trouverItineraires())
+//! \param[in,out] p_reseau: une copie du réseau propre au thread appelant; elle est rendue telle quelle
+//! \pre p_requete a été vérifiée par verifierRequeteOD() contre les horaires de p_gtfs
+std::vector<Itineraire> itinerairesRequeteOD(const DonneesGTFS &p_gtfs, ReseauGTFS &p_reseau,
+                                             const RequeteOD &p_requete,
+                                             const std::vector<Coordonnees> &p_autresDestinations) {
+    vector<Coordonnees> destinations(1, p_requete.destination);
+    destinations.insert(destinations.end(), p_autresDestinations.begin(), p_autresDestinations.end());
+    return avecPointsOD(p_gtfs, p_reseau, p_requete, destinations, [&p_reseau]() {
+        vector<Itineraire> itineraires;
+        p_reseau.trouverItineraires(itineraires);
+        return itineraires;
+    });
+}
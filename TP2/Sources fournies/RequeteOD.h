@@ -0,0 +1,35 @@
+//
+// Requêtes origine-destination en texte (serveur, traitement par lot) et leur calcul sur une copie du réseau
+//
+
+#ifndef TP2_REQUETEOD_H
+#define TP2_REQUETEOD_H
+
+#include <string>
+#include <vector>
+#include "DonneesGTFS.h"
+#include "ReseauGTFS.h"
+
+/*!
+ * \struct RequeteOD
+ * \brief Une requête d'itinéraire: d'un point origine à un point destination, à une date et une heure de départ
+ */
+struct RequeteOD
+{
+    Coordonnees origine;
+    Coordonnees destination;
+    Date date;
+    Heure depart;
+};
+
+std::vector<std::string> separerChamps(const std::string &, char = ',');
+Heure lireHeure(const std::string &);
+Date lireDate(const std::string &);
+RequeteOD lireRequeteOD(const std::vector<std::string> &);
+void verifierRequeteOD(const RequeteOD &, const Date &, const Heure &, const Heure &);
+unsigned int dureeRequeteOD(const DonneesGTFS &, ReseauGTFS &, const RequeteOD &);
+Itineraire itineraireRequeteOD(const DonneesGTFS &, ReseauGTFS &, const RequeteOD &);
+std::vector<Itineraire> itinerairesRequeteOD(const DonneesGTFS &, ReseauGTFS &, const RequeteOD &,
+                                             const std::vector<Coordonnees> &);
+
+#endif //TP2_REQUETEOD_H
@@ -3,7 +3,19 @@
 //
 
 #include "ReseauGTFS.h"
+#include "Mesures.h"
+#include "trace.h"
 #include <sys/time.h>
+#include <thread>
+#include <mutex>
+#include <condition_variable>
+#include <atomic>
+#include <exception>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <fcntl.h>
+#include <unistd.h>
+#include <sstream>
 
 using namespace std;
 
@@ -17,6 +29,28 @@ long tempsExecution(const timeval &tv1, const timeval &tv2) {
     return dtms;
 }
 
+//! \brief politique de Graphe::plusCourtCheminElague() qui n'élague aucun arc: à partir de chaque arrêt solutionné d'une
+//! \brief station à distance de marche d'un point destination, elle relâche les arcs implicites vers ces points
+struct ArcsVersDestination {
+    const vector<unsigned int> &stationDuSommet;
+    const vector<vector<pair<size_t, unsigned int> > > &arcsVersDestination;
+    const vector<pair<size_t, unsigned int> > aucunArc;
+
+    ArcsVersDestination(const vector<unsigned int> &p_stationDuSommet,
+                        const vector<vector<pair<size_t, unsigned int> > > &p_arcsVersDestination)
+            : stationDuSommet(p_stationDuSommet), arcsVersDestination(p_arcsVersDestination) {
+    }
+
+    void solutionner(size_t, unsigned int) {}
+
+    bool relacher(size_t, size_t, unsigned int) { return true; }
+
+    //les sommets origine et destination n'appartiennent à aucune station
+    const vector<pair<size_t, unsigned int> > &arcsImplicites(size_t p_u) const {
+        return p_u < stationDuSommet.size() ? arcsVersDestination[stationDuSommet[p_u]] : aucunArc;
+    }
+};
+
 size_t ReseauGTFS::getNbArcsOrigineVersStations() const {
     return m_nbArcsOrigineVersStations;
 }
@@ -25,131 +59,571 @@ size_t ReseauGTFS::getNbArcsStationsVersDestination() const {
     return m_nbArcsStationsVersDestination;
 }
 
+size_t ReseauGTFS::getNbArcs() const {
+    return m_leGraphe.getNbArcs();
+}
+
 double ReseauGTFS::getDistMaxMarche() const {
     return distanceMaxMarche;
 }
 
+//! \brief dresse le bilan mémoire du réseau, un poste par structure de données
+//! \brief les objets Arret pointés par m_arretDuSommet appartiennent aux données GTFS (voir DonneesGTFS::bilanMemoire());
+//! \brief seuls les pointeurs sont comptés ici, à l'exception des arrets fantômes des points origine et destination.
+//! \brief Le sommet de chaque arret est rangé dans l'Arret lui-même (Arret::getSommet()): il n'y a pas de table inverse.
+//! \brief Les arcs lus dans une image projetée en mémoire ne sont pas alloués: ils forment un poste à part.
+//! \param[out] p_bilan: les postes du bilan
+void ReseauGTFS::bilanMemoire(std::vector<PosteMemoire> &p_bilan) const {
+    p_bilan.clear();
+    p_bilan.push_back({"ReseauGTFS (objet)", 1, sizeof(ReseauGTFS)});
+    p_bilan.push_back({"m_leGraphe (listes d'adjacence)", m_leGraphe.getNbArcs(), m_leGraphe.getOctetsListesAdj()});
+    if (m_image)
+        p_bilan.push_back({"m_leGraphe (arcs de l'image, projetés)", m_leGraphe.getNbSommets(),
+                           m_leGraphe.getOctetsImage()});
+    if (m_leGraphe.getOctetsGrapheInverse() > 0)
+        p_bilan.push_back({"m_leGraphe (graphe inversé des profils)", m_leGraphe.getNbArcs(),
+                           m_leGraphe.getOctetsGrapheInverse()});
+
+    size_t octets = octetsVecteur(m_arretDuSommet);
+    if (m_origine_dest_ajoute) {
+        CompteurAllocations compteur;
+        auto copie = allocate_shared<Arret>(AllocateurCompteur<Arret>(compteur), *m_arretDuSommet[m_sommetOrigine]);
+        octets += (1 + m_sommetsDestination.size()) * compteur.octets;
+    }
+    p_bilan.push_back({"m_arretDuSommet", m_arretDuSommet.size(), octets});
+    p_bilan.push_back({"m_voyageDuSommet", m_voyageDuSommet.size(), octetsVecteur(m_voyageDuSommet)});
+    p_bilan.push_back({"m_stationDuSommet", m_stationDuSommet.size(), octetsVecteur(m_stationDuSommet)});
+
+    octets = octetsVecteur(m_arcsVersDestination);
+    size_t nbArcsVersDestination = 0;
+    for (const auto &arcs : m_arcsVersDestination) {
+        octets += octetsVecteur(arcs);
+        nbArcsVersDestination += arcs.size();
+    }
+    p_bilan.push_back({"m_arcsVersDestination", nbArcsVersDestination, octets});
+    p_bilan.push_back({"m_stationsVersDestination", m_stationsVersDestination.size(),
+                       octetsVecteur(m_stationsVersDestination)});
+    p_bilan.push_back({"m_sommetsDestination", m_sommetsDestination.size(), octetsVecteur(m_sommetsDestination)});
+}
+
+//! \brief exécute p_travail(t, debut, fin) sur p_nbThreads threads; le thread t traite la tranche contiguë [debut, fin)
+//! \brief des p_nbElements éléments, de sorte que la concaténation des résultats des tranches suit l'ordre des éléments
+//! \brief la première exception lancée par un thread est relancée une fois tous les threads terminés
+//! \param[in] p_nom: le nom de l'intervalle de trace de chaque tranche
+void traiterParTranches(const char *p_nom, size_t p_nbElements, unsigned int p_nbThreads,
+                        const function<void(unsigned int, size_t, size_t)> &p_travail) {
+    vector<exception_ptr> erreurs(p_nbThreads);
+    auto travailleur = [&](unsigned int t) {
+        Trace::Intervalle intervalle(p_nom, "construction");
+        try {
+            p_travail(t, t * p_nbElements / p_nbThreads, (t + 1) * p_nbElements / p_nbThreads);
+        }
+        catch (...) {
+            erreurs[t] = current_exception();
+        }
+    };
+
+    vector<thread> threads;
+    for (unsigned int t = 1; t < p_nbThreads; ++t) threads.push_back(thread(travailleur, t));
+    travailleur(0);
+    for (auto &t : threads) t.join();
+
+    for (auto &e : erreurs)
+        if (e) rethrow_exception(e);
+}
+
 //! \brief construit le réseau GTFS à partir des données GTFS
+//! \brief Les arcs de chaque étape sont produits en parallèle dans des tampons (un par thread), puis ajoutés au graphe
+//! \brief d'un seul coup par Graphe::ajouterArcs(); le graphe obtenu ne dépend pas du nombre de threads
 //! \param[in] Un objet DonneesGTFS
+//! \param[in] p_nbThreads: le nombre de threads à utiliser (0 pour le nombre de coeurs disponibles)
 //! \post constuit un réseau GTFS représenté par un graphe orienté pondéré avec poids non négatifs
 //! \post initialise la variable m_origine_dest_ajoute à false car les points origine et destination ne font pas parti du graphe
-//! \post insère les données requises dans m_arretDuSommet et m_sommetDeArret et construit le graphe m_leGraphe
-ReseauGTFS::ReseauGTFS(const DonneesGTFS &p_gtfs)
-        : m_leGraphe(p_gtfs.getNbArrets()), m_origine_dest_ajoute(false) {
+//! \post insère les données requises dans m_arretDuSommet, attribue son sommet à chaque arret et construit le graphe m_leGraphe
+ReseauGTFS::ReseauGTFS(const DonneesGTFS &p_gtfs, unsigned int p_nbThreads)
+        : m_leGraphe(p_gtfs.getNbArrets()), m_numerotationSommets(p_gtfs.nouvelleNumerotationSommets()),
+          m_origine_dest_ajoute(false) {
+
+    if (p_nbThreads == 0) p_nbThreads = max(1u, thread::hardware_concurrency());
 
     //Le graphe possède p_gtfs.getNbArrets() sommets, mais il n'a pas encore d'arcs
-    ajouterArcsVoyages(p_gtfs);
-    ajouterArcsAttentes(p_gtfs);
-    ajouterArcsTransferts(p_gtfs);
+    vector<vector<GrapheCompact::ArcAAjouter> > tampons;
+    ajouterArcsVoyages(p_gtfs, p_nbThreads, tampons);
+    ajouterArcsAttentes(p_gtfs, p_nbThreads, tampons);
+    ajouterArcsTransferts(p_gtfs, p_nbThreads, tampons);
+    Trace::Intervalle intervalle("Graphe::ajouterArcs", "construction");
+    m_leGraphe.ajouterArcs(tampons, p_nbThreads);
 }
 
 //! \brief ajout des arcs dus aux voyages
-//! \brief insère les arrêts (associés aux sommets) dans m_arretDuSommet et m_sommetDeArret
+//! \brief insère les arrêts (associés aux sommets) dans m_arretDuSommet et attribue à chaque arret son sommet (Arret::setSommet())
+//! \brief les sommets d'un voyage sont consécutifs; une somme préfixe du nombre d'arrêts donne le premier sommet de chacun
+//! \param[in,out] p_tampons: p_nbThreads tampons d'arcs y sont ajoutés
 //! \throws logic_error si une incohérence est détecté lors de cette étape de construction du graphe
-void ReseauGTFS::ajouterArcsVoyages(const DonneesGTFS &p_gtfs) {
+void ReseauGTFS::ajouterArcsVoyages(const DonneesGTFS &p_gtfs, unsigned int p_nbThreads,
+                                    vector<vector<GrapheCompact::ArcAAjouter> > &p_tampons) {
+    Trace::Intervalle intervalle("ReseauGTFS::ajouterArcsVoyages", "construction");
     if (m_arretDuSommet.size() != 0){
         throw logic_error("Le graphe est déjà initialisé avec des noeuds, l'ajout supplémentaire est impossible");
     }
 
     const map<std::string, Voyage> &m_voyages = p_gtfs.getVoyages();
-    size_t sommetCourant = m_arretDuSommet.size();
-
+    vector<const Voyage *> voyages;
+    vector<size_t> premierSommet(1, 0);
     for (auto itr = m_voyages.begin(); itr != m_voyages.end(); ++itr) {
-        const set<Arret::Ptr, Voyage::compArret> m_arretsVoyage = itr->second.getArrets();
+        voyages.push_back(&itr->second);
+        premierSommet.push_back(premierSommet.back() + itr->second.getArrets().size());
+    }
+    m_arretDuSommet.resize(premierSommet.back());
+    m_voyageDuSommet.resize(premierSommet.back());
 
-        auto voyage = m_arretsVoyage.begin();
-        auto precedent = *voyage;
+    const size_t premierTampon = p_tampons.size();
+    p_tampons.resize(premierTampon + p_nbThreads);
 
-        // On insère les premiers arrets de chaque voyage
-        m_sommetDeArret.insert({*voyage, sommetCourant});
-        m_arretDuSommet.push_back(*voyage);
+    traiterParTranches("tranche des voyages", voyages.size(), p_nbThreads, [&](unsigned int t, size_t debut, size_t fin) {
+        vector<GrapheCompact::ArcAAjouter> &tampon = p_tampons[premierTampon + t];
+        for (size_t numeroVoyage = debut; numeroVoyage < fin; ++numeroVoyage) {
+            const Voyage::Arrets &m_arretsVoyage = voyages[numeroVoyage]->getArrets();
+            size_t sommetCourant = premierSommet[numeroVoyage];
 
-        ++sommetCourant;
-        ++voyage;
+            // La boucle itère sur un couple de valeurs et ajoute les arcs respectifs
+            for (auto voyage = m_arretsVoyage.begin(); voyage != m_arretsVoyage.end(); ++voyage, ++sommetCourant) {
+                m_arretDuSommet[sommetCourant] = *voyage;
+                (*voyage)->setSommet(sommetCourant);
+                m_voyageDuSommet[sommetCourant] = (unsigned int) numeroVoyage;
+                if (voyage == m_arretsVoyage.begin()) continue;
 
-        // La boucle itère sur un couple de valeurs et ajoute les arcs respectifs
-        while (voyage != m_arretsVoyage.end()) {
-            m_sommetDeArret.insert({*voyage, sommetCourant});
-            m_arretDuSommet.push_back(*voyage);
+                auto poids = (*voyage)->getHeureArrivee() - m_arretDuSommet[sommetCourant - 1]->getHeureArrivee();
 
-            auto poids = (*voyage)->getHeureArrivee() - precedent->getHeureArrivee();
+                if (poids < 0) {
+                    throw logic_error("Un poids négatif a été détecté");
+                }
 
-            if (poids < 0) {
-                throw logic_error("Un poids négatif a été détecté");
+                tampon.push_back({sommetCourant - 1, sommetCourant, (unsigned int) poids});
             }
-
-            m_leGraphe.ajouterArc((sommetCourant - 1), sommetCourant, poids);
-
-            precedent = *voyage;
-            ++sommetCourant;
-            ++voyage;
         }
-    }
+    });
 }
 
 //! \brief ajout des arcs dus aux attentes à chaque station
+//! \brief associe aussi chaque sommet à sa station (m_stationDuSommet)
+//! \param[in,out] p_tampons: p_nbThreads tampons d'arcs y sont ajoutés
 //! \throws logic_error si une incohérence est détecté lors de cette étape de construction du graphe
-void ReseauGTFS::ajouterArcsAttentes(const DonneesGTFS &p_gtfs) {
+void ReseauGTFS::ajouterArcsAttentes(const DonneesGTFS &p_gtfs, unsigned int p_nbThreads,
+                                     vector<vector<GrapheCompact::ArcAAjouter> > &p_tampons) {
+    Trace::Intervalle intervalle("ReseauGTFS::ajouterArcsAttentes", "construction");
     const map<unsigned int, Station> &m_stations = p_gtfs.getStations();
-
-    // On itère sur les stations
+    vector<const Station *> stations;
     for (auto station = m_stations.begin(); station != m_stations.end(); ++station) {
-        const multimap<Heure, Arret::Ptr> &arretsStation = station->second.getArrets();
+        stations.push_back(&station->second);
+    }
+
+    m_stationDuSommet.assign(m_arretDuSommet.size(), numeric_limits<unsigned int>::max());
+    m_arcsVersDestination.assign(m_stations.size(), vector<pair<size_t, unsigned int> >());
 
-        // On note le premier arret d'une station
-        auto arretStation = arretsStation.begin();
-        auto precedent = arretStation;
+    const size_t premierTampon = p_tampons.size();
+    p_tampons.resize(premierTampon + p_nbThreads);
+
+    // On itère sur les stations
+    traiterParTranches("tranche des attentes", stations.size(), p_nbThreads, [&](unsigned int t, size_t debut, size_t fin) {
+        vector<GrapheCompact::ArcAAjouter> &tampon = p_tampons[premierTampon + t];
+        for (size_t numeroStation = debut; numeroStation < fin; ++numeroStation) {
+            const Station::Arrets &arretsStation = stations[numeroStation]->getArrets();
+
+            for (auto arretStation = arretsStation.begin(); arretStation != arretsStation.end(); ++arretStation) {
+                size_t sommet = (*arretStation).second->getSommet();
+                m_stationDuSommet[sommet] = (unsigned int) numeroStation;
+
+                // On note le premier arret d'une station; aucune attente entre deux arrets du même voyage
+                auto precedent = arretStation;
+                if (arretStation == arretsStation.begin() or
+                    (*--precedent).second->getVoyageId() == (*arretStation).second->getVoyageId()) {
+                    continue;
+                }
 
-        ++arretStation;
-        while (arretStation != arretsStation.end()) {
-            if ((*precedent).second->getVoyageId() != (*arretStation).second->getVoyageId()) {
                 auto tempsAttente = (*arretStation).first - (*precedent).first;
 
                 if (tempsAttente < 0){
                     throw logic_error("Une attente négative est impossible");
                 }
-                m_leGraphe.ajouterArc(m_sommetDeArret[(*precedent).second], m_sommetDeArret[(*arretStation).second],
-                                      tempsAttente);
+                tampon.push_back({(*precedent).second->getSommet(), sommet, (unsigned int) tempsAttente});
             }
-            // On passe au prochain couple d'arrets
-            precedent = arretStation;
-            ++arretStation;
         }
-    }
+    });
 }
 
 
 //! \brief ajouts des arcs dus aux transferts entre stations
+//! \brief chaque arret de la station source est relié au premier arret de la station d'arrivée atteignable après le temps de transfert
+//! \param[in,out] p_tampons: p_nbThreads tampons d'arcs y sont ajoutés
 //! \throws logic_error si une incohérence est détecté lors de cette étape de construction du graphe
-void ReseauGTFS::ajouterArcsTransferts(const DonneesGTFS &p_gtfs) {
+void ReseauGTFS::ajouterArcsTransferts(const DonneesGTFS &p_gtfs, unsigned int p_nbThreads,
+                                       vector<vector<GrapheCompact::ArcAAjouter> > &p_tampons) {
+    Trace::Intervalle intervalle("ReseauGTFS::ajouterArcsTransferts", "construction");
     const std::vector<std::tuple<unsigned int, unsigned int, unsigned int> > &m_transferts = p_gtfs.getTransferts();
     const map<unsigned int, Station> &m_stations = p_gtfs.getStations();
 
-    // On itère sur les tuples de transferts
-    for (auto transfert = m_transferts.begin(); transfert != m_transferts.end(); ++transfert) {
-        auto fromStationID = get<0>(*transfert);
-        auto toStationID = get<1>(*transfert);
-        auto transferTime = get<2>(*transfert);
-
-        auto arretsSource = m_stations.find(fromStationID)->second.getArrets();
-        auto arretsSuivants = m_stations.find(toStationID)->second.getArrets();
+    const size_t premierTampon = p_tampons.size();
+    p_tampons.resize(premierTampon + p_nbThreads);
 
-        for (auto arret = arretsSource.begin(); arret != arretsSource.end(); ++arret) {
-            Heure heureArret = (*arret).first;
-            auto prochainArret = arretsSuivants.lower_bound(heureArret.add_secondes(transferTime));
+    // On itère sur les tuples de transferts
+    traiterParTranches("tranche des transferts", m_transferts.size(), p_nbThreads, [&](unsigned int t, size_t debut, size_t fin) {
+        vector<GrapheCompact::ArcAAjouter> &tampon = p_tampons[premierTampon + t];
+        for (auto transfert = m_transferts.begin() + debut; transfert != m_transferts.begin() + fin; ++transfert) {
+            auto fromStationID = get<0>(*transfert);
+            auto toStationID = get<1>(*transfert);
+            auto transferTime = get<2>(*transfert);
+
+            const Station::Arrets &arretsSource = m_stations.at(fromStationID).getArrets();
+            const Station::Arrets &arretsSuivants = m_stations.at(toStationID).getArrets();
+
+            // Fusion des deux stations triées par heure: l'heure minimale d'arrivée ne fait qu'augmenter, donc le
+            // prochain arret de la station d'arrivée ne fait qu'avancer (O(n + m) par transfert)
+            auto prochainArret = arretsSuivants.begin();
+            for (auto arret = arretsSource.begin(); arret != arretsSource.end(); ++arret) {
+                const Heure heureMinimale = (*arret).first.add_secondes(transferTime);
+                while (prochainArret != arretsSuivants.end() and (*prochainArret).first < heureMinimale) {
+                    ++prochainArret;
+                }
+                if (prochainArret == arretsSuivants.end()) break;
 
-            if (prochainArret != arretsSuivants.end()) {
                 auto tempsTransferts =  (*prochainArret).first - (*arret).first;
 
                 if (tempsTransferts <= 0){
                     throw logic_error("Un transfert de 0 ou négatif a été détecté");
                 }
 
-                m_leGraphe.ajouterArc(m_sommetDeArret[(*arret).second], m_sommetDeArret[(*prochainArret).second],
-                                      tempsTransferts);
+                tampon.push_back({(*arret).second->getSommet(), (*prochainArret).second->getSommet(),
+                                  (unsigned int) tempsTransferts});
+            }
+        }
+    });
+}
+
+//! \brief met à jour le réseau après DonneesGTFS::appliquerRetards(), sans reconstruire le graphe
+//! \brief Seuls les arcs qui dépendent des heures des arrets modifiés sont touchés: les arcs sortant des arrets des stations
+//! \brief modifiées et des stations qui ont un transfert vers elles sont regénérés (voyage, attente, puis transferts, comme à
+//! \brief la construction), et le poids de l'arc de voyage qui précède un arret modifié est corrigé ailleurs.
+//! \param[in] p_gtfs: l'objet DonneesGTFS qui a servi à construire le réseau, après l'application des retards
+//! \param[in] p_arretsModifies: les arrets retournés par DonneesGTFS::appliquerRetards()
+//! \post le graphe est identique à celui d'un réseau construit à partir de p_gtfs (à la numérotation des sommets près)
+//! \throws logic_error si les points origine et destination sont présents dans le graphe ou si le graphe est une image
+//! \throws logic_error si une incohérence est détectée lors de la regénération des arcs
+void ReseauGTFS::appliquerRetards(const DonneesGTFS &p_gtfs, const std::vector<Arret::Ptr> &p_arretsModifies) {
+    verifierNumerotation(p_gtfs, "appliquerRetards");
+    if (m_origine_dest_ajoute)
+        throw logic_error("ReseauGTFS::appliquerRetards(): il faut enlever les points origine et destination avant d'appliquer des retards");
+    if (m_image)
+        throw logic_error("ReseauGTFS::appliquerRetards(): les arcs d'un réseau projeté en mémoire sont en lecture seule");
+    if (p_arretsModifies.empty()) return;
+
+    const map<std::string, Voyage> &m_voyages = p_gtfs.getVoyages();
+    const map<unsigned int, Station> &m_stations = p_gtfs.getStations();
+    const std::vector<std::tuple<unsigned int, unsigned int, unsigned int> > &m_transferts = p_gtfs.getTransferts();
+
+    // Les stations modifiées, et celles dont les arcs sortants en dépendent (transfert vers une station modifiée)
+    set<unsigned int> stationsModifiees;
+    for (auto arret = p_arretsModifies.begin(); arret != p_arretsModifies.end(); ++arret) {
+        stationsModifiees.insert((*arret)->getStationId());
+    }
+    set<unsigned int> stationsARegenerer = stationsModifiees;
+    for (auto transfert = m_transferts.begin(); transfert != m_transferts.end(); ++transfert) {
+        if (stationsModifiees.count(get<1>(*transfert))) stationsARegenerer.insert(get<0>(*transfert));
+    }
+
+    for (auto stationId = stationsARegenerer.begin(); stationId != stationsARegenerer.end(); ++stationId) {
+        const Station::Arrets &arretsStation = m_stations.at(*stationId).getArrets();
+        for (auto arretStation = arretsStation.begin(); arretStation != arretsStation.end(); ++arretStation) {
+            m_leGraphe.enleverArcs((*arretStation).second->getSommet());
+        }
+    }
+
+    // Arcs de voyage et d'attente, dans l'ordre de la construction
+    for (auto stationId = stationsARegenerer.begin(); stationId != stationsARegenerer.end(); ++stationId) {
+        const Station::Arrets &arretsStation = m_stations.at(*stationId).getArrets();
+        for (auto arretStation = arretsStation.begin(); arretStation != arretsStation.end(); ++arretStation) {
+            const Arret::Ptr &arret = (*arretStation).second;
+            const Voyage::Arrets &arretsVoyage = m_voyages.at(arret->getVoyageId()).getArrets();
+            auto suivant = arretsVoyage.upper_bound(arret);
+            if (suivant != arretsVoyage.end()) {
+                auto poids = (*suivant)->getHeureArrivee() - arret->getHeureArrivee();
+                if (poids < 0) {
+                    throw logic_error("Un poids négatif a été détecté");
+                }
+                m_leGraphe.ajouterArc(arret->getSommet(), (*suivant)->getSommet(), (unsigned int) poids);
+            }
+
+            auto prochain = arretStation;
+            if (++prochain != arretsStation.end() and
+                (*prochain).second->getVoyageId() != arret->getVoyageId()) {
+                m_leGraphe.ajouterArc(arret->getSommet(), (*prochain).second->getSommet(),
+                                      (unsigned int) ((*prochain).first - (*arretStation).first));
             }
         }
     }
+
+    // Arcs de transfert, dans l'ordre de m_transferts (voir ajouterArcsTransferts())
+    for (auto transfert = m_transferts.begin(); transfert != m_transferts.end(); ++transfert) {
+        if (stationsARegenerer.count(get<0>(*transfert)) == 0) continue;
+
+        const Station::Arrets &arretsSource = m_stations.at(get<0>(*transfert)).getArrets();
+        const Station::Arrets &arretsSuivants = m_stations.at(get<1>(*transfert)).getArrets();
+        auto prochainArret = arretsSuivants.begin();
+        for (auto arret = arretsSource.begin(); arret != arretsSource.end(); ++arret) {
+            const Heure heureMinimale = (*arret).first.add_secondes(get<2>(*transfert));
+            while (prochainArret != arretsSuivants.end() and (*prochainArret).first < heureMinimale) {
+                ++prochainArret;
+            }
+            if (prochainArret == arretsSuivants.end()) break;
+
+            auto tempsTransferts = (*prochainArret).first - (*arret).first;
+            if (tempsTransferts <= 0) {
+                throw logic_error("Un transfert de 0 ou négatif a été détecté");
+            }
+            m_leGraphe.ajouterArc((*arret).second->getSommet(), (*prochainArret).second->getSommet(),
+                                  (unsigned int) tempsTransferts);
+        }
+    }
+
+    // L'arc de voyage vers un arret modifié part d'un arret dont la station n'a peut-être pas été regénérée
+    for (auto arret = p_arretsModifies.begin(); arret != p_arretsModifies.end(); ++arret) {
+        const Voyage::Arrets &arretsVoyage = m_voyages.at((*arret)->getVoyageId()).getArrets();
+        auto precedent = arretsVoyage.find(*arret);
+        if (precedent == arretsVoyage.begin() or stationsARegenerer.count((*--precedent)->getStationId())) continue;
+
+        auto poids = (*arret)->getHeureArrivee() - (*precedent)->getHeureArrivee();
+        if (poids < 0) {
+            throw logic_error("Un poids négatif a été détecté");
+        }
+        m_leGraphe.modifierPoids((*precedent)->getSommet(), (*arret)->getSommet(), (unsigned int) poids);
+    }
+}
+
+//! \brief indice du point (x, y) le long de la courbe de Hilbert qui parcourt une grille p_cote x p_cote (p_cote une puissance de 2)
+unsigned long long indiceHilbert(unsigned int p_cote, unsigned int x, unsigned int y) {
+    unsigned long long indice = 0;
+    for (unsigned int s = p_cote / 2; s > 0; s /= 2) {
+        unsigned int rx = (x & s) > 0;
+        unsigned int ry = (y & s) > 0;
+        indice += (unsigned long long) s * s * ((3 * rx) ^ ry);
+        if (ry == 0) { //rotation du quadrant
+            if (rx == 1) {
+                x = p_cote - 1 - x;
+                y = p_cote - 1 - y;
+            }
+            swap(x, y);
+        }
+    }
+    return indice;
+}
+
+//! \brief applique une renumérotation aux éléments de p_vecteur: l'élément i devient l'élément p_nouveauNumero[i]
+template<typename T>
+void permuter(vector<T> &p_vecteur, const vector<size_t> &p_nouveauNumero) {
+    vector<T> permute(p_vecteur.size());
+    for (size_t i = 0; i < p_vecteur.size(); ++i) permute[p_nouveauNumero[i]] = p_vecteur[i];
+    p_vecteur.swap(permute);
+}
+
+//! \brief Renumérote les sommets du graphe selon leur localité station-temps
+//! \brief Les stations sont ordonnées le long d'une courbe de Hilbert (sur leurs coordonnées GPS) et les arrêts de chaque
+//! \brief station reçoivent des numéros consécutifs en ordre d'heure. Les arcs d'attente relient alors des sommets voisins,
+//! \brief et les arcs de voyage et de transfert relient le plus souvent des stations proches, donc des sommets proches.
+//! \brief Cette étape est optionnelle; les plus courts chemins obtenus ont les mêmes longueurs.
+//! \param[in] p_gtfs: l'objet DonneesGTFS qui a servi à construire le réseau
+//! \throws logic_error si les points origine et destination sont présents dans le graphe
+//! \post m_leGraphe, m_arretDuSommet, m_voyageDuSommet, m_stationDuSommet et le sommet de chaque arret
+//! \post sont renumérotés de façon cohérente
+void ReseauGTFS::renumeroterSommets(const DonneesGTFS &p_gtfs) {
+    Trace::Intervalle intervalle("ReseauGTFS::renumeroterSommets", "construction");
+    verifierNumerotation(p_gtfs, "renumeroterSommets");
+    if (m_origine_dest_ajoute)
+        throw logic_error("ReseauGTFS::renumeroterSommets(): il faut enlever les points origine et destination avant de renuméroter");
+
+    const map<unsigned int, Station> &m_stations = p_gtfs.getStations();
+    if (m_stations.empty()) return;
+
+    // Boîte englobante des stations, discrétisée en une grille de 2^16 x 2^16
+    double latMin = numeric_limits<double>::max(), latMax = -numeric_limits<double>::max();
+    double lonMin = numeric_limits<double>::max(), lonMax = -numeric_limits<double>::max();
+    for (auto station = m_stations.begin(); station != m_stations.end(); ++station) {
+        latMin = min(latMin, station->second.getCoords().getLatitude());
+        latMax = max(latMax, station->second.getCoords().getLatitude());
+        lonMin = min(lonMin, station->second.getCoords().getLongitude());
+        lonMax = max(lonMax, station->second.getCoords().getLongitude());
+    }
+    const unsigned int cote = 1u << 16;
+    auto cellule = [&](double p_valeur, double p_min, double p_max) {
+        return p_max > p_min ? (unsigned int) ((cote - 1) * (p_valeur - p_min) / (p_max - p_min)) : 0u;
+    };
+
+    vector<pair<unsigned long long, const Station *> > stationsOrdonnees;
+    for (auto station = m_stations.begin(); station != m_stations.end(); ++station) {
+        const Coordonnees &coords = station->second.getCoords();
+        stationsOrdonnees.push_back({indiceHilbert(cote, cellule(coords.getLongitude(), lonMin, lonMax),
+                                                   cellule(coords.getLatitude(), latMin, latMax)), &station->second});
+    }
+    stable_sort(stationsOrdonnees.begin(), stationsOrdonnees.end(),
+                [](const pair<unsigned long long, const Station *> &a, const pair<unsigned long long, const Station *> &b) {
+                    return a.first < b.first;
+                });
+
+    const size_t nbSommets = m_arretDuSommet.size();
+    vector<size_t> nouveauNumero(nbSommets, numeric_limits<size_t>::max());
+    size_t prochainNumero = 0;
+    for (auto station = stationsOrdonnees.begin(); station != stationsOrdonnees.end(); ++station) {
+        const Station::Arrets &arretsStation = station->second->getArrets();
+        for (auto arret = arretsStation.begin(); arret != arretsStation.end(); ++arret) {
+            nouveauNumero[(*arret).second->getSommet()] = prochainNumero++;
+        }
+    }
+    // Les sommets qui n'appartiennent à aucune station (il ne devrait pas y en avoir) suivent dans leur ordre actuel
+    for (size_t sommet = 0; sommet < nbSommets; ++sommet) {
+        if (nouveauNumero[sommet] == numeric_limits<size_t>::max()) nouveauNumero[sommet] = prochainNumero++;
+    }
+
+    m_leGraphe.renumeroter(nouveauNumero);
+    permuter(m_arretDuSommet, nouveauNumero);
+    permuter(m_voyageDuSommet, nouveauNumero);
+    permuter(m_stationDuSommet, nouveauNumero);
+    for (size_t sommet = 0; sommet < nbSommets; ++sommet) m_arretDuSommet[sommet]->setSommet(sommet);
+    m_numerotationSommets = p_gtfs.nouvelleNumerotationSommets(); //les copies de ce réseau ne sont plus à jour
+}
+
+//! \brief entête d'une image du réseau (voir ReseauGTFS::sauvegarderImage())
+struct EnteteImageReseau {
+    char magie[8];
+    uint64_t nbSommets;
+    uint64_t nbVoyages;
+    uint64_t nbStations;
+};
+
+const char magieImageReseau[8] = {'R', 'E', 'S', 'G', 'T', 'F', 'S', '2'};
+
+//! \brief écrit un tableau d'entiers de 32 bits, complété par des zéros jusqu'à un multiple de 8 octets
+void ecrireTableau(ostream &p_sortie, const vector<unsigned int> &p_tableau) {
+    p_sortie.write(reinterpret_cast<const char *>(p_tableau.data()), p_tableau.size() * sizeof(unsigned int));
+    const char zeros[8] = {0};
+    p_sortie.write(zeros, (8 - (p_tableau.size() * sizeof(unsigned int)) % 8) % 8);
+}
+
+//! \brief lit un tableau de p_nb entiers de 32 bits écrit par ecrireTableau() à la position p_position de l'image
+//! \post p_position est avancée à la fin du tableau
+//! \throws logic_error si l'image est tronquée
+void lireTableau(const char *p_image, size_t p_taille, size_t &p_position, size_t p_nb, vector<unsigned int> &p_tableau) {
+    const size_t taille = (p_nb * sizeof(unsigned int) + 7) / 8 * 8;
+    if (p_position + taille > p_taille) throw logic_error("ReseauGTFS::ReseauGTFS(): image tronquée");
+    const unsigned int *debut = reinterpret_cast<const unsigned int *>(p_image + p_position);
+    p_tableau.assign(debut, debut + p_nb);
+    p_position += taille;
+}
+
+//! \brief Sauvegarde le graphe construit et les tables par sommet dans une image binaire, indépendante de sa position en
+//! \brief mémoire, qui peut ensuite être projetée en lecture seule par ReseauGTFS(const DonneesGTFS &, const std::string &)
+//! \brief Format (ordre des octets de la machine): EnteteImageReseau, l'image de m_leGraphe (Graphe::ecrireImage()), puis
+//! \brief m_voyageDuSommet, m_stationDuSommet et, pour chaque arret dans l'ordre des voyages de p_gtfs,
+//! \brief son sommet (ce qui permet de retrouver l'arret de chaque sommet, même après renumeroterSommets())
+//! \param[in] p_gtfs: l'objet DonneesGTFS qui a servi à construire le réseau
+//! \param[in] p_fichierImage: le nom du fichier à produire
+//! \throws logic_error si les points origine et destination sont présents ou si l'écriture échoue
+void ReseauGTFS::sauvegarderImage(const DonneesGTFS &p_gtfs, const std::string &p_fichierImage) const {
+    verifierNumerotation(p_gtfs, "sauvegarderImage");
+    if (m_origine_dest_ajoute)
+        throw logic_error("ReseauGTFS::sauvegarderImage(): il faut enlever les points origine et destination avant de sauvegarder");
+
+    ofstream sortie(p_fichierImage, ios::binary | ios::trunc);
+    if (!sortie.is_open())
+        throw logic_error("ReseauGTFS::sauvegarderImage(): impossible d'ouvrir le fichier " + p_fichierImage);
+
+    EnteteImageReseau entete;
+    copy(magieImageReseau, magieImageReseau + 8, entete.magie);
+    entete.nbSommets = m_arretDuSommet.size();
+    entete.nbVoyages = p_gtfs.getVoyages().size();
+    entete.nbStations = p_gtfs.getStations().size();
+    sortie.write(reinterpret_cast<const char *>(&entete), sizeof(entete));
+
+    m_leGraphe.ecrireImage(sortie);
+    ecrireTableau(sortie, m_voyageDuSommet);
+    ecrireTableau(sortie, m_stationDuSommet);
+
+    vector<unsigned int> sommetDeArret;
+    sommetDeArret.reserve(m_arretDuSommet.size());
+    const map<std::string, Voyage> &m_voyages = p_gtfs.getVoyages();
+    for (auto voyage = m_voyages.begin(); voyage != m_voyages.end(); ++voyage) {
+        for (auto arret = voyage->second.getArrets().begin(); arret != voyage->second.getArrets().end(); ++arret) {
+            sommetDeArret.push_back((unsigned int) (*arret)->getSommet());
+        }
+    }
+    ecrireTableau(sortie, sommetDeArret);
+
+    sortie.close();
+    if (sortie.fail()) throw logic_error("ReseauGTFS::sauvegarderImage(): l'écriture de " + p_fichierImage + " a échoué");
+}
+
+//! \brief construit le réseau GTFS en projetant en mémoire (mmap, lecture seule) une image produite par sauvegarderImage()
+//! \brief Les arcs du graphe sont lus directement dans l'image: les processus qui projettent le même fichier en partagent
+//! \brief une seule copie physique, et le démarrage ne coûte que le chargement des pages. Les tables par sommet (4 octets
+//! \brief par sommet chacune) sont copiées, et chaque arret de p_gtfs reçoit son sommet.
+//! \param[in] p_gtfs: les mêmes données GTFS que celles qui ont servi à produire l'image
+//! \param[in] p_fichierImage: le nom du fichier image
+//! \throws logic_error si le fichier ne peut être projeté ou s'il ne correspond pas à p_gtfs
+ReseauGTFS::ReseauGTFS(const DonneesGTFS &p_gtfs, const std::string &p_fichierImage)
+        : m_leGraphe(0), m_numerotationSommets(p_gtfs.nouvelleNumerotationSommets()), m_origine_dest_ajoute(false) {
+    int descripteur = open(p_fichierImage.c_str(), O_RDONLY);
+    if (descripteur < 0)
+        throw logic_error("ReseauGTFS::ReseauGTFS(): impossible d'ouvrir l'image " + p_fichierImage);
+    struct stat infos;
+    if (fstat(descripteur, &infos) != 0) {
+        close(descripteur);
+        throw logic_error("ReseauGTFS::ReseauGTFS(): impossible de lire la taille de l'image " + p_fichierImage);
+    }
+    const size_t taille = infos.st_size;
+    void *adresse = taille > 0 ? mmap(nullptr, taille, PROT_READ, MAP_SHARED, descripteur, 0) : MAP_FAILED;
+    close(descripteur);
+    if (adresse == MAP_FAILED)
+        throw logic_error("ReseauGTFS::ReseauGTFS(): impossible de projeter l'image " + p_fichierImage);
+    m_image = shared_ptr<const char>(static_cast<const char *>(adresse),
+                                     [taille](const char *p_adresse) { munmap((void *) p_adresse, taille); });
+    const char *image = m_image.get();
+
+    if (taille < sizeof(EnteteImageReseau))
+        throw logic_error("ReseauGTFS::ReseauGTFS(): image tronquée");
+    const EnteteImageReseau &entete = *reinterpret_cast<const EnteteImageReseau *>(image);
+    if (!equal(magieImageReseau, magieImageReseau + 8, entete.magie))
+        throw logic_error("ReseauGTFS::ReseauGTFS(): " + p_fichierImage + " n'est pas une image de réseau");
+    if (entete.nbSommets != p_gtfs.getNbArrets() or entete.nbVoyages != p_gtfs.getVoyages().size() or
+        entete.nbStations != p_gtfs.getStations().size())
+        throw logic_error("ReseauGTFS::ReseauGTFS(): l'image ne correspond pas aux données GTFS");
+
+    const size_t nbSommets = entete.nbSommets;
+    size_t position = sizeof(EnteteImageReseau);
+    position += m_leGraphe.attacherImage(image + position, taille - position);
+    if (m_leGraphe.getNbSommets() != nbSommets)
+        throw logic_error("ReseauGTFS::ReseauGTFS(): image incohérente");
+
+    vector<unsigned int> sommetDeArret;
+    lireTableau(image, taille, position, nbSommets, m_voyageDuSommet);
+    lireTableau(image, taille, position, nbSommets, m_stationDuSommet);
+    lireTableau(image, taille, position, nbSommets, sommetDeArret);
+    //ces tables servent d'indices dans les recherches: une valeur hors bornes est refusée ici
+    for (size_t sommet = 0; sommet < nbSommets; ++sommet) {
+        if (m_voyageDuSommet[sommet] >= entete.nbVoyages or m_stationDuSommet[sommet] >= entete.nbStations)
+            throw logic_error("ReseauGTFS::ReseauGTFS(): image incohérente");
+    }
+    m_arcsVersDestination.assign(entete.nbStations, vector<pair<size_t, unsigned int> >());
+
+    m_arretDuSommet.resize(nbSommets);
+    size_t numeroArret = 0;
+    const map<std::string, Voyage> &m_voyages = p_gtfs.getVoyages();
+    for (auto voyage = m_voyages.begin(); voyage != m_voyages.end(); ++voyage) {
+        for (auto arret = voyage->second.getArrets().begin(); arret != voyage->second.getArrets().end(); ++arret) {
+            if (numeroArret == nbSommets or sommetDeArret[numeroArret] >= nbSommets)
+                throw logic_error("ReseauGTFS::ReseauGTFS(): l'image ne correspond pas aux données GTFS");
+            m_arretDuSommet[sommetDeArret[numeroArret]] = *arret;
+            (*arret)->setSommet(sommetDeArret[numeroArret]);
+            ++numeroArret;
+        }
+    }
 }
 
 //! \brief ajoute des arcs au réseau GTFS à partir des données GTFS
@@ -160,73 +634,118 @@ void ReseauGTFS::ajouterArcsTransferts(const DonneesGTFS &p_gtfs) {
 //! \throws logic_error si une incohérence est détecté lors de la construction du graphe
 //! \post constuit un réseau GTFS représenté par un graphe orienté pondéré avec poids non négatifs
 //! \post assigne la variable m_origine_dest_ajoute à true (car les points orignine et destination font parti du graphe)
-//! \post insère dans m_sommetsVersDestination les numéros de sommets connectés au point destination
+//! \post insère dans m_arcsVersDestination les temps de marche des stations vers le point destination
 void ReseauGTFS::ajouterArcsOrigineDestination(const DonneesGTFS &p_gtfs, const Coordonnees &p_pointOrigine,
                                                const Coordonnees &p_pointDestination) {
+    ajouterArcsOrigineDestinations(p_gtfs, p_pointOrigine, vector<Coordonnees>(1, p_pointDestination),
+                                   p_gtfs.getTempsDebut());
+}
+
+//! \brief comme ajouterArcsOrigineDestination(), mais pour un départ du point origine à p_heureDepart
+void ReseauGTFS::ajouterArcsOrigineDestination(const DonneesGTFS &p_gtfs, const Coordonnees &p_pointOrigine,
+                                               const Coordonnees &p_pointDestination, const Heure &p_heureDepart) {
+    ajouterArcsOrigineDestinations(p_gtfs, p_pointOrigine, vector<Coordonnees>(1, p_pointDestination), p_heureDepart);
+}
+
+//! \brief ajoute des arcs au réseau GTFS pour un point origine et plusieurs points destination, pour un départ du
+//! \brief point origine au début de l'intervalle de temps de p_gtfs (voir la version avec une heure de départ)
+void ReseauGTFS::ajouterArcsOrigineDestinations(const DonneesGTFS &p_gtfs, const Coordonnees &p_pointOrigine,
+                                                const vector<Coordonnees> &p_pointsDestination) {
+    ajouterArcsOrigineDestinations(p_gtfs, p_pointOrigine, p_pointsDestination, p_gtfs.getTempsDebut());
+}
+
+//! \brief ajoute des arcs au réseau GTFS pour un point origine et plusieurs points destination
+//! \brief Un sommet est ajouté pour chaque point destination; une seule recherche (itineraires()) les solutionne tous
+//! \brief Aucun arc n'est ajouté vers les points destination: chaque station à distance de marche reçoit plutôt, dans
+//! \brief m_arcsVersDestination, le temps de marche vers ce point, évalué par la recherche lorsqu'elle solutionne un de ses arrêts
+//! \param[in] p_gtfs: un objet DonneesGTFS
+//! \param[in] p_pointOrigine: les coordonnées GPS du point origine
+//! \param[in] p_pointsDestination: les coordonnées GPS des points destination
+//! \param[in] p_heureDepart: l'heure de départ du point origine
+//! \throws logic_error si une incohérence est détecté lors de la construction du graphe
+//! \throws logic_error si une des destinations ou l'origine n'a aucun arrêt dans le rayon maximal de marche;
+//! \brief dans ce cas, le réseau est remis dans l'état où il était avant l'appel
+//! \post assigne la variable m_origine_dest_ajoute à true (car les points orignine et destination font parti du graphe)
+//! \post insère dans m_arcsVersDestination les temps de marche des stations vers les points destination
+void ReseauGTFS::ajouterArcsOrigineDestinations(const DonneesGTFS &p_gtfs, const Coordonnees &p_pointOrigine,
+                                                const vector<Coordonnees> &p_pointsDestination,
+                                                const Heure &p_heureDepart) {
+    MesuresItineraire::Chronometre chronometre(MesuresItineraire::AjoutArcs);
+    Trace::Intervalle intervalle("ReseauGTFS::ajouterArcsOrigineDestinations", "requete");
+    verifierNumerotation(p_gtfs, "ajouterArcsOrigineDestinations");
     if (m_origine_dest_ajoute == true){
         throw logic_error("Des arcs d'origine sont déjà présents dans le graphe");
     }
+    if (p_pointsDestination.empty()) {
+        throw logic_error("Il faut au moins un point destination");
+    }
 
-    const Heure heureDepart = p_gtfs.getTempsDebut();
+    const Heure &heureDepart = p_heureDepart;
+    m_heureDepart = p_heureDepart;
+    const size_t nbDestinations = p_pointsDestination.size();
     m_nbArcsStationsVersDestination = 0;
     m_nbArcsOrigineVersStations = 0;
 
-    // On crée des Arrets pointeurs pour l'origine et la destination
+    // On crée des Arrets pointeurs pour l'origine et chacune des destinations
     Arret::Ptr pointOrigine = make_shared<Arret>(stationIdOrigine, heureDepart, Heure(2, 0, 0), 0, "ORIGINE");
-    Arret::Ptr pointDestination = make_shared<Arret>(stationIdDestination, heureDepart, Heure(2, 0, 0), 0,
-                                                     "DESTINATION");
-
-    m_leGraphe.resize(m_leGraphe.getNbSommets() + 2);
 
-    m_sommetOrigine = m_leGraphe.getNbSommets() - 2;
-    m_sommetDestination = m_leGraphe.getNbSommets() - 1;
+    m_leGraphe.resize(m_leGraphe.getNbSommets() + 1 + nbDestinations);
 
-    // Ajouts des sommets dans le graphe
+    m_sommetOrigine = m_leGraphe.getNbSommets() - 1 - nbDestinations;
+    pointOrigine->setSommet(m_sommetOrigine);
     m_arretDuSommet.push_back(pointOrigine);
-    m_arretDuSommet.push_back(pointDestination);
-
-    m_sommetDeArret.insert({pointOrigine, m_sommetOrigine});
-    m_sommetDeArret.insert({pointDestination, m_sommetDestination});
 
+    // Ajouts des sommets destination dans le graphe
+    m_sommetsDestination.clear();
+    for (size_t k = 0; k < nbDestinations; ++k) {
+        Arret::Ptr pointDestination = make_shared<Arret>(stationIdDestination, heureDepart, Heure(2, 0, 0), 0,
+                                                         "DESTINATION");
+        m_sommetsDestination.push_back(m_sommetOrigine + 1 + k);
+        pointDestination->setSommet(m_sommetsDestination.back());
+        m_arretDuSommet.push_back(pointDestination);
+    }
+    m_sommetDestination = m_sommetsDestination.front();
 
+    vector<size_t> nbArcsVersDestination(nbDestinations, 0);
     const map<unsigned int, Station> &m_stations = p_gtfs.getStations();
 
-    for (auto station = m_stations.begin(); station != m_stations.end(); ++station) {
+    unsigned int numeroStation = 0;
+    for (auto station = m_stations.begin(); station != m_stations.end(); ++station, ++numeroStation) {
         const Coordonnees &coordStation = station->second.getCoords();
+        const Station::Arrets &arretsStation = station->second.getArrets();
 
         double distanceMarcheOrigine = p_pointOrigine - coordStation;
-        double distanceMarcheDestination = p_pointDestination - coordStation;
 
         if (distanceMarcheOrigine < distanceMaxMarche) {
-            const multimap<Heure, Arret::Ptr> &arretsStation = station->second.getArrets();
-
             unsigned int secondesMarche = ((distanceMarcheOrigine / vitesseDeMarche) * 3600);
             Heure tempsMarcheOrigine = heureDepart.add_secondes(secondesMarche);
 
-            multimap<Heure, Arret::Ptr>::const_iterator arretAccessible = arretsStation.lower_bound(tempsMarcheOrigine);
+            Station::Arrets::const_iterator arretAccessible = arretsStation.lower_bound(tempsMarcheOrigine);
 
             if (arretAccessible != arretsStation.end()) {
-                m_leGraphe.ajouterArc(m_sommetOrigine, m_sommetDeArret[(*arretAccessible).second],
+                m_leGraphe.ajouterArc(m_sommetOrigine, (*arretAccessible).second->getSommet(),
                                       (*arretAccessible).first - heureDepart);
                 ++m_nbArcsOrigineVersStations;
             }
         }
-        if (distanceMarcheDestination < distanceMaxMarche) {
-            const multimap<Heure, Arret::Ptr> &arretsStation = station->second.getArrets();
+        for (size_t k = 0; k < nbDestinations; ++k) {
+            double distanceMarcheDestination = p_pointsDestination[k] - coordStation;
+            if (distanceMarcheDestination >= distanceMaxMarche) continue;
 
             unsigned int tempsMarcheDestination = (distanceMarcheDestination / vitesseDeMarche) * 3600;
 
-            for (auto arret = arretsStation.begin(); arret != arretsStation.end(); ++arret) {
-                size_t sommetArret = m_sommetDeArret[(*arret).second];
-
-                m_leGraphe.ajouterArc(sommetArret, m_sommetDestination, tempsMarcheDestination);
-                m_sommetsVersDestination.push_back(sommetArret);
-                ++m_nbArcsStationsVersDestination;
-            }
+            if (arretsStation.empty()) continue;
+            if (m_arcsVersDestination[numeroStation].empty()) m_stationsVersDestination.push_back(numeroStation);
+            m_arcsVersDestination[numeroStation].push_back({m_sommetsDestination[k], tempsMarcheDestination});
+            ++nbArcsVersDestination[k];
+            m_nbArcsStationsVersDestination += arretsStation.size(); //un arc implicite par arrêt de la station
         }
     }
 
-    if (m_nbArcsStationsVersDestination == 0 or m_nbArcsOrigineVersStations == 0){
+    if (m_nbArcsOrigineVersStations == 0 or
+        find(nbArcsVersDestination.begin(), nbArcsVersDestination.end(), 0) != nbArcsVersDestination.end()){
+        m_origine_dest_ajoute = true;
+        enleverArcsOrigineDestination();
         throw logic_error("Aucun arrêt de bus n'est dans le rayon maximal de marche de la destination ou de l'origine");
     }
 
@@ -234,38 +753,66 @@ void ReseauGTFS::ajouterArcsOrigineDestination(const DonneesGTFS &p_gtfs, const
     m_origine_dest_ajoute = true;
 }
 
+//! \brief Ajoute au graphe, à partir de chaque arrêt des stations à distance de marche d'un point destination, un arc
+//! \brief vers ce point: les moteurs qui ne connaissent pas les arcs implicites de m_arcsVersDestination (voir
+//! \brief dureeItineraire(MoteurRecherche)) peuvent alors chercher le même itinéraire que la recherche élaguée.
+//! \brief Ces arcs, bien plus nombreux que les entrées de m_arcsVersDestination, sont réservés à la comparaison des moteurs.
+//! \param[in] p_gtfs: les données GTFS qui ont servi à ajouterArcsOrigineDestination()
+//! \throws logic_error si les points origine et destination n'ont pas été ajoutés ou si les arcs sont déjà explicites
+//! \post enleverArcsOrigineDestination() enlève aussi ces arcs
+void ReseauGTFS::expliciterArcsVersDestination(const DonneesGTFS &p_gtfs) {
+    verifierNumerotation(p_gtfs, "expliciterArcsVersDestination");
+    if (!m_origine_dest_ajoute)
+        throw logic_error(
+                "ReseauGTFS::expliciterArcsVersDestination(): il faut ajouter un point origine et un point destination");
+    if (!m_arcsExplicites.empty())
+        throw logic_error("ReseauGTFS::expliciterArcsVersDestination(): les arcs vers la destination sont déjà explicites");
+
+    vector<const Station *> stations;
+    for (const auto &station : p_gtfs.getStations()) stations.push_back(&station.second);
+    for (unsigned int numeroStation : m_stationsVersDestination) {
+        for (const auto &arret : stations[numeroStation]->getArrets()) {
+            for (const auto &arc : m_arcsVersDestination[numeroStation]) {
+                m_leGraphe.ajouterArc(arret.second->getSommet(), arc.first, arc.second);
+                m_arcsExplicites.push_back({arret.second->getSommet(), arc.first});
+            }
+        }
+    }
+}
+
 //! \brief Remet ReseauGTFS dans l'était qu'il était avant l'exécution de ReseauGTFS::ajouterArcsOrigineDestination()
+//! \brief (ou de ReseauGTFS::ajouterArcsOrigineDestinations())
 //! \param[in] p_gtfs: un objet DonneesGTFS
 //! \throws logic_error si une incohérence est détecté lors de la modification du graphe
-//! \post Enlève de ReaseauGTFS tous les arcs allant du point source vers un arrêt de station et ceux allant d'un arrêt de station vers la destination
+//! \post Enlève de ReaseauGTFS tous les arcs allant du point source vers un arrêt de station
 //! \post assigne la variable m_origine_dest_ajoute à false (les points orignine et destination sont enlevés du graphe)
-//! \post enlève les données de m_sommetsVersDestination
+//! \post vide les entrées de m_arcsVersDestination des stations reliées à une destination
+//! \post enlève les arcs ajoutés par expliciterArcsVersDestination()
 void ReseauGTFS::enleverArcsOrigineDestination() {
+    Trace::Intervalle intervalle("ReseauGTFS::enleverArcsOrigineDestination", "requete");
     if (m_origine_dest_ajoute == false) {
         throw logic_error("Il n'y a pas d'arcs d'origine et de destination dans le graphe");
     }
 
-    for (auto sommet = m_sommetsVersDestination.begin(); sommet != m_sommetsVersDestination.end(); ++sommet) {
-        m_leGraphe.enleverArc(*sommet, m_sommetDestination);
+    for (auto station = m_stationsVersDestination.begin(); station != m_stationsVersDestination.end(); ++station) {
+        m_arcsVersDestination[*station].clear();
     }
-    m_leGraphe.resize(m_leGraphe.getNbSommets() - 2);
-
-    // Allons chercher les pointeurs des sommets Origine et Destination
-    Arret::Ptr sommetOrigine = m_arretDuSommet[m_sommetOrigine];
-    Arret::Ptr sommetDestination = m_arretDuSommet[m_sommetDestination];
-
-    // Suppression m_sommetDeArret
-    m_sommetDeArret.erase(sommetOrigine);
-    m_sommetDeArret.erase(sommetDestination);
+    //en ordre inverse d'ajout: enleverArc() cherche à partir de la fin de la liste d'adjacence
+    for (auto arc = m_arcsExplicites.rbegin(); arc != m_arcsExplicites.rend(); ++arc) {
+        m_leGraphe.enleverArc(arc->first, arc->second);
+    }
+    m_arcsExplicites.clear();
 
-    // Suppression des sommets dans m_arretDuSommet
-    m_arretDuSommet.pop_back();
-    m_arretDuSommet.pop_back();
+    // Suppression des sommets origine et destination dans m_arretDuSommet
+    const size_t nbSommetsFantomes = 1 + m_sommetsDestination.size();
+    m_arretDuSommet.resize(m_arretDuSommet.size() - nbSommetsFantomes);
+    m_leGraphe.resize(m_leGraphe.getNbSommets() - nbSommetsFantomes);
 
     // Mise à jour des paramètres du graphe
     m_nbArcsOrigineVersStations = 0;
     m_nbArcsStationsVersDestination = 0;
-    m_sommetsVersDestination.clear();
+    m_stationsVersDestination.clear();
+    m_sommetsDestination.clear();
     m_origine_dest_ajoute = false;
 }
 
@@ -275,133 +822,577 @@ void ReseauGTFS::enleverArcsOrigineDestination() {
 //! \param[in] p_afficherItineraire: true si on désire afficher l'itinéraire et false autrement
 //! \param[out] p_tempsExecution: le temps d'exécution de l'algorithme de plus court chemin utilisé
 //! \throws logic_error si un problème survient durant l'exécution de la méthode
+//! \post la recherche, la reconstruction et le rendu de l'itinéraire sont mesurés dans MesuresItineraire
 void ReseauGTFS::itineraire(const DonneesGTFS &p_gtfs, bool p_afficherItineraire, long &p_tempsExecution) const {
     if (!m_origine_dest_ajoute)
         throw logic_error(
-                "ReseauGTFS::afficherItineraire(): il faut ajouter un point origine et un point destination avant d'obtenir un itinéraire");
+                "ReseauGTFS::itineraire(): il faut ajouter un point origine et un point destination avant d'obtenir un itinéraire");
 
     vector<size_t> chemin;
 
     timeval tv1;
     timeval tv2;
     if (gettimeofday(&tv1, 0) != 0)
-        throw logic_error("ReseauGTFS::afficherItineraire(): gettimeofday() a échoué pour tv1");
-    unsigned int tempsDuTrajet = m_leGraphe.plusCourtChemin(m_sommetOrigine, m_sommetDestination, chemin);
+        throw logic_error("ReseauGTFS::itineraire(): gettimeofday() a échoué pour tv1");
+    unsigned int tempsDuTrajet = rechercherChemin(chemin);
     if (gettimeofday(&tv2, 0) != 0)
-        throw logic_error("ReseauGTFS::afficherItineraire(): gettimeofday() a échoué pour tv2");
+        throw logic_error("ReseauGTFS::itineraire(): gettimeofday() a échoué pour tv2");
     p_tempsExecution = tempsExecution(tv1, tv2);
 
-    if (tempsDuTrajet == numeric_limits<unsigned int>::max()) {
-        if (p_afficherItineraire)
-            cout << "La destination n'est pas atteignable de l'orignine durant cet intervalle de temps" << endl;
-        return;
+    Itineraire resultat;
+    {
+        MesuresItineraire::Chronometre chronometre(MesuresItineraire::Reconstruction);
+        reconstruireItineraire(chemin, tempsDuTrajet, resultat);
     }
+    if (!p_afficherItineraire) return;
+    MesuresItineraire::Chronometre chronometre(MesuresItineraire::Rendu);
+    resultat.ecrireTexte(p_gtfs, cout);
+    cout << flush;
+}
 
-    if (tempsDuTrajet == 0) {
-        if (p_afficherItineraire) cout << "Vous êtes déjà situé à la destination demandée" << endl;
-        return;
+//! \brief Trouve l'itinéraire du point d'origine au point destination préalablement choisis, sans l'afficher
+//! \brief Ne modifie pas le réseau: plusieurs threads peuvent l'appeler à la fois sur un même réseau
+//! \return l'itinéraire; Itineraire::ecrireTexte() ou Itineraire::ecrireJson() le rendent au besoin
+//! \throws logic_error si les points origine et destination n'ont pas été ajoutés ou si le chemin est incohérent
+//! \post la recherche et la reconstruction sont mesurées dans MesuresItineraire
+Itineraire ReseauGTFS::trouverItineraire() const {
+    if (!m_origine_dest_ajoute)
+        throw logic_error(
+                "ReseauGTFS::trouverItineraire(): il faut ajouter un point origine et un point destination avant d'obtenir un itinéraire");
+
+    vector<size_t> chemin;
+    unsigned int tempsDuTrajet = rechercherChemin(chemin);
+    Itineraire resultat;
+    MesuresItineraire::Chronometre chronometre(MesuresItineraire::Reconstruction);
+    reconstruireItineraire(chemin, tempsDuTrajet, resultat);
+    return resultat;
+}
+
+//! \brief cherche le plus court chemin du point origine au (premier) point destination avec RechercheDirecte
+//! \param[out] p_chemin: les sommets du chemin
+//! \return la longueur du chemin (= numeric_limits<unsigned int>::max() si la destination est inatteignable)
+unsigned int ReseauGTFS::rechercherChemin(std::vector<size_t> &p_chemin) const {
+    GrapheCompact::SansStatistiques aucune;
+    return rechercherChemin(RechercheDirecte, p_chemin, aucune);
+}
+
+//! \brief cherche le plus court chemin du point origine au (premier) point destination avec un moteur de
+//! \brief plusCourtCheminElague() (RechercheDirecte ou RechercheSansElagage)
+//! \param[out] p_chemin: les sommets du chemin
+//! \param[in,out] p_statistiques: la politique de statistiques de la recherche
+//! \return la longueur du chemin (= numeric_limits<unsigned int>::max() si la destination est inatteignable)
+//! \post la recherche est mesurée dans MesuresItineraire et tracée
+template<typename Statistiques>
+unsigned int ReseauGTFS::rechercherChemin(MoteurRecherche p_moteur, std::vector<size_t> &p_chemin,
+                                         Statistiques &p_statistiques) const {
+    MesuresItineraire::Chronometre chronometre(MesuresItineraire::Recherche);
+    Trace::Intervalle intervalle("recherche", "requete");
+    if (p_moteur == RechercheSansElagage) {
+        GrapheCompact::SansElagage sansElagage;
+        return m_leGraphe.plusCourtCheminElague(m_sommetOrigine, m_sommetDestination, p_chemin, sansElagage,
+                                                p_statistiques);
     }
+    ArcsVersDestination arcs(m_stationDuSommet, m_arcsVersDestination);
+    return m_leGraphe.plusCourtCheminElague(m_sommetOrigine, m_sommetDestination, p_chemin, arcs, p_statistiques);
+}
 
-    //un chemin non trivial a été trouvé
-    if (chemin.size() <= 2)
-        throw logic_error("ReseauGTFS::afficherItineraire(): un chemin non trivial doit contenir au moins 3 sommets");
-    if (m_arretDuSommet[chemin[0]]->getStationId() != stationIdOrigine)
-        throw logic_error("ReseauGTFS::afficherItineraire(): le premier noeud du chemin doit être le point origine");
-    if (m_arretDuSommet[chemin[chemin.size() - 1]]->getStationId() != stationIdDestination)
+//! \brief Calcule, sans l'afficher, la durée de l'itinéraire du point d'origine au point destination préalablement choisis
+//! \brief Ne modifie pas le réseau: plusieurs threads peuvent l'appeler à la fois sur un même réseau
+//! \return la durée, en secondes, du trajet (= numeric_limits<unsigned int>::max() si la destination est inatteignable)
+//! \throws logic_error si les points origine et destination n'ont pas été ajoutés
+unsigned int ReseauGTFS::dureeItineraire() const {
+    if (!m_origine_dest_ajoute)
+        throw logic_error(
+                "ReseauGTFS::dureeItineraire(): il faut ajouter un point origine et un point destination avant d'obtenir un itinéraire");
+
+    vector<size_t> chemin;
+    return rechercherChemin(chemin);
+}
+
+//! \brief comme dureeItineraire(), en comptant aussi l'effort de la recherche
+//! \param[out] p_statistiques: l'effort de la recherche (voir GrapheGenerique::StatistiquesRecherche)
+unsigned int ReseauGTFS::dureeItineraire(StatistiquesRecherche &p_statistiques) const {
+    if (!m_origine_dest_ajoute)
+        throw logic_error(
+                "ReseauGTFS::dureeItineraire(): il faut ajouter un point origine et un point destination avant d'obtenir un itinéraire");
+
+    vector<size_t> chemin;
+    p_statistiques = StatistiquesRecherche();
+    return rechercherChemin(RechercheDirecte, chemin, p_statistiques);
+}
+
+//! \brief comme dureeItineraire(), avec le moteur de recherche p_moteur (voir MoteurRecherche)
+//! \pre pour RechercheSansElagage et RechercheGraphe, expliciterArcsVersDestination() doit avoir été appelée
+//! \throws logic_error si les points origine et destination n'ont pas été ajoutés ou si le moteur demande des arcs
+//! \brief explicites vers la destination qui n'ont pas été ajoutés
+unsigned int ReseauGTFS::dureeItineraire(MoteurRecherche p_moteur) const {
+    if (!m_origine_dest_ajoute)
+        throw logic_error(
+                "ReseauGTFS::dureeItineraire(): il faut ajouter un point origine et un point destination avant d'obtenir un itinéraire");
+    if ((p_moteur == RechercheSansElagage or p_moteur == RechercheGraphe) and m_arcsExplicites.empty())
+        throw logic_error("ReseauGTFS::dureeItineraire(): ce moteur demande expliciterArcsVersDestination()");
+
+    vector<size_t> chemin;
+    if (p_moteur != RechercheGraphe) {
+        GrapheCompact::SansStatistiques aucune;
+        return rechercherChemin(p_moteur, chemin, aucune);
+    }
+    MesuresItineraire::Chronometre chronometre(MesuresItineraire::Recherche);
+    Trace::Intervalle intervalle("recherche", "requete");
+    return m_leGraphe.plusCourtChemin(m_sommetOrigine, m_sommetDestination, chemin);
+}
+
+//! \brief Trouve, en une seule recherche, le plus court chemin menant du point d'origine à chacun des points destination
+//! \brief préalablement choisis par ajouterArcsOrigineDestinations()
+//! \brief Permet également d'affichier les itinéraires et retourne le temps d'exécution de l'algorithme de plus court chemin utilisé
+//! \param[in] p_afficherItineraire: true si on désire afficher les itinéraires et false autrement
+//! \param[out] p_tempsExecution: le temps d'exécution de l'algorithme de plus court chemin utilisé
+//! \throws logic_error si un problème survient durant l'exécution de la méthode
+//! \post la recherche, la reconstruction et le rendu des itinéraires sont mesurés dans MesuresItineraire
+void ReseauGTFS::itineraires(const DonneesGTFS &p_gtfs, bool p_afficherItineraire, long &p_tempsExecution) const {
+    if (!m_origine_dest_ajoute)
         throw logic_error(
-                "ReseauGTFS::afficherItineraire(): le dernier noeud du chemin doit être le point destination");
+                "ReseauGTFS::itineraires(): il faut ajouter un point origine et des points destination avant d'obtenir des itinéraires");
 
-    if (p_afficherItineraire) {
-        std::cout << std::endl;
-        std::cout << "=====================" << std::endl;
-        std::cout << "     ITINÉRAIRE      " << std::endl;
-        std::cout << "=====================" << std::endl;
-        std::cout << std::endl;
+    vector<vector<size_t> > chemins;
+    vector<unsigned int> tempsDesTrajets;
+
+    timeval tv1;
+    timeval tv2;
+    if (gettimeofday(&tv1, 0) != 0)
+        throw logic_error("ReseauGTFS::itineraires(): gettimeofday() a échoué pour tv1");
+    rechercherChemins(chemins, tempsDesTrajets);
+    if (gettimeofday(&tv2, 0) != 0)
+        throw logic_error("ReseauGTFS::itineraires(): gettimeofday() a échoué pour tv2");
+    p_tempsExecution = tempsExecution(tv1, tv2);
+
+    vector<Itineraire> resultats(chemins.size());
+    {
+        MesuresItineraire::Chronometre chronometre(MesuresItineraire::Reconstruction);
+        for (size_t k = 0; k < chemins.size(); ++k) reconstruireItineraire(chemins[k], tempsDesTrajets[k], resultats[k]);
+    }
+    if (!p_afficherItineraire) return;
+    MesuresItineraire::Chronometre chronometre(MesuresItineraire::Rendu);
+    for (size_t k = 0; k < resultats.size(); ++k) {
+        cout << "\nDestination numéro " << k + 1 << "\n";
+        resultats[k].ecrireTexte(p_gtfs, cout);
     }
+    cout << flush;
+}
 
-    if (p_afficherItineraire) cout << "Heure de départ du point d'origine: " << p_gtfs.getTempsDebut() << endl;
-    Arret::Ptr ptr_a = m_arretDuSommet.at(chemin[0]);
-    Arret::Ptr ptr_b = m_arretDuSommet.at(chemin[1]);
-    if (p_afficherItineraire)
-        cout << "Rendez vous à la station " << p_gtfs.getStations().at(ptr_b->getStationId()) << endl;
+//! \brief Trouve, en une seule recherche et sans les afficher, les itinéraires du point d'origine à chacun des points
+//! \brief destination préalablement choisis par ajouterArcsOrigineDestinations()
+//! \param[out] p_itineraires: p_itineraires[k] est l'itinéraire vers le point destination k
+//! \throws logic_error si les points origine et destination n'ont pas été ajoutés ou si un chemin est incohérent
+//! \post la recherche et la reconstruction sont mesurées dans MesuresItineraire
+void ReseauGTFS::trouverItineraires(std::vector<Itineraire> &p_itineraires) const {
+    if (!m_origine_dest_ajoute)
+        throw logic_error(
+                "ReseauGTFS::trouverItineraires(): il faut ajouter un point origine et des points destination avant d'obtenir des itinéraires");
+
+    vector<vector<size_t> > chemins;
+    vector<unsigned int> tempsDesTrajets;
+    rechercherChemins(chemins, tempsDesTrajets);
+    MesuresItineraire::Chronometre chronometre(MesuresItineraire::Reconstruction);
+    p_itineraires.assign(chemins.size(), Itineraire());
+    for (size_t k = 0; k < chemins.size(); ++k) reconstruireItineraire(chemins[k], tempsDesTrajets[k], p_itineraires[k]);
+}
 
-    unsigned int sommet = 1;
+//! \brief cherche, en une seule recherche et avec RechercheDirecte, le plus court chemin du point origine vers chacun
+//! \brief des points destination
+//! \param[out] p_chemins: p_chemins[k] est le chemin vers le point destination k
+//! \param[out] p_longueurs: p_longueurs[k] est sa longueur (= numeric_limits<unsigned int>::max() si inatteignable)
+//! \post la recherche est mesurée dans MesuresItineraire et tracée
+void ReseauGTFS::rechercherChemins(std::vector<std::vector<size_t> > &p_chemins,
+                                   std::vector<unsigned int> &p_longueurs) const {
+    MesuresItineraire::Chronometre chronometre(MesuresItineraire::Recherche);
+    Trace::Intervalle intervalle("recherche", "requete");
+    ArcsVersDestination arcs(m_stationDuSommet, m_arcsVersDestination);
+    m_leGraphe.plusCourtsCheminsElague(m_sommetOrigine, m_sommetsDestination, p_chemins, p_longueurs, arcs);
+}
 
-    while (sommet < chemin.size() - 1) {
-        ptr_a = ptr_b;
+//! \brief Vérifie un chemin du point origine vers un point destination et en tire les étapes de l'itinéraire, en un seul
+//! \brief parcours et sans consulter les données GTFS: les stations et les heures sont celles des arrêts du chemin
+//! \param[in] p_chemin: les sommets du chemin, du point origine au point destination
+//! \param[in] p_tempsDuTrajet: la longueur du chemin (= numeric_limits<unsigned int>::max() si inatteignable)
+//! \param[out] p_itineraire: l'itinéraire
+//! \throws logic_error si le chemin est incohérent
+void ReseauGTFS::reconstruireItineraire(const vector<size_t> &p_chemin, unsigned int p_tempsDuTrajet,
+                                        Itineraire &p_itineraire) const {
+    p_itineraire.heureDepart = m_heureDepart;
+    p_itineraire.duree = 0;
+    p_itineraire.etapes.clear();
+    if (p_tempsDuTrajet == numeric_limits<unsigned int>::max()) {
+        p_itineraire.statut = Itineraire::Inatteignable;
+        return;
+    }
+    if (p_tempsDuTrajet == 0) {
+        p_itineraire.statut = Itineraire::SurPlace;
+        return;
+    }
+
+    //un chemin non trivial a été trouvé
+    if (p_chemin.size() <= 2)
+        throw logic_error("ReseauGTFS::reconstruireItineraire(): un chemin non trivial doit contenir au moins 3 sommets");
+    if (m_arretDuSommet[p_chemin[0]]->getStationId() != stationIdOrigine)
+        throw logic_error("ReseauGTFS::reconstruireItineraire(): le premier noeud du chemin doit être le point origine");
+    if (m_arretDuSommet[p_chemin[p_chemin.size() - 1]]->getStationId() != stationIdDestination)
+        throw logic_error(
+                "ReseauGTFS::reconstruireItineraire(): le dernier noeud du chemin doit être le point destination");
+
+    p_itineraire.statut = Itineraire::Trouve;
+    p_itineraire.duree = p_tempsDuTrajet;
+    auto marche = [&p_itineraire](unsigned int p_depart, unsigned int p_arrivee) {
+        p_itineraire.etapes.push_back({EtapeItineraire::Marche, p_depart, p_arrivee, 0, Arret::Ptr(), Arret::Ptr()});
+    };
+
+    //a et b sont les arrêts des sommets consécutifs p_chemin[sommet - 1] et p_chemin[sommet]; leurs voyages sont
+    //comparés par numéro (les sommets fantômes n'en ont pas), sans copier les identifiants
+    auto voyage = [&](size_t p_k) {
+        return p_chemin[p_k] < m_voyageDuSommet.size() ? m_voyageDuSommet[p_chemin[p_k]]
+                                                       : numeric_limits<unsigned int>::max();
+    };
+    size_t sommet = 1;
+    const Arret *a = m_arretDuSommet.at(p_chemin[0]).get();
+    const Arret *b = m_arretDuSommet.at(p_chemin[1]).get();
+    auto avancer = [&]() {
+        a = b;
         ++sommet;
-        ptr_b = m_arretDuSommet.at(chemin[sommet]);
-        while (ptr_b->getStationId() == ptr_a->getStationId()) {
-            ptr_a = ptr_b;
-            ++sommet;
-            ptr_b = m_arretDuSommet.at(chemin[sommet]);
-        }
+        b = m_arretDuSommet.at(p_chemin[sommet]).get();
+    };
+    marche(Itineraire::POINT_ORIGINE, b->getStationId());
+
+    while (sommet < p_chemin.size() - 1) {
+        avancer();
+        while (b->getStationId() == a->getStationId()) avancer();
         //on a changé de station
-        if (ptr_b->getStationId() == stationIdDestination) //cas où on est arrivé à la destination
+        if (b->getStationId() == stationIdDestination) //cas où on est arrivé à la destination
         {
-            if (sommet != chemin.size() - 1)
+            if (sommet != p_chemin.size() - 1)
                 throw logic_error(
-                        "ReseauGTFS::afficherItineraire(): incohérence de fin de chemin lors d'un changement de station");
+                        "ReseauGTFS::reconstruireItineraire(): incohérence de fin de chemin lors d'un changement de station");
             break;
         }
-        if (sommet == chemin.size() - 1)
-            throw logic_error("ReseauGTFS::afficherItineraire(): on ne devrait pas être arrivé à destination");
+        if (sommet == p_chemin.size() - 1)
+            throw logic_error("ReseauGTFS::reconstruireItineraire(): on ne devrait pas être arrivé à destination");
         //on a changé de station mais sommet n'est pas le noeud destination
-        string voyage_id_a = ptr_a->getVoyageId();
-        string voyage_id_b = ptr_b->getVoyageId();
-        if (voyage_id_a != voyage_id_b) //on a changé de station à pieds
+        if (voyage(sommet - 1) != voyage(sommet)) //on a changé de station à pieds
         {
-            if (p_afficherItineraire)
-                cout << "De cette station, rendez-vous à pieds à la station "
-                     << p_gtfs.getStations().at(ptr_b->getStationId()) << endl;
-        } else //on a changé de station avec un voyage
+            marche(a->getStationId(), b->getStationId());
+            continue;
+        }
+        //on a changé de station avec un voyage: allons à la dernière station de ce voyage
+        size_t montee = sommet - 1;
+        avancer();
+        while (voyage(sommet) == voyage(sommet - 1)) avancer();
+        p_itineraire.etapes.push_back({EtapeItineraire::Autobus, m_arretDuSommet[p_chemin[montee]]->getStationId(),
+                                       a->getStationId(), voyage(montee),
+                                       m_arretDuSommet[p_chemin[montee]], m_arretDuSommet[p_chemin[sommet - 1]]});
+        if (b->getStationId() == stationIdDestination) //cas où on est arrivé à la destination
         {
-            Heure heure = ptr_a->getHeureArrivee();
-            unsigned int ligne_id = p_gtfs.getVoyages().at(voyage_id_a).getLigne();
-            string ligne_numero = p_gtfs.getLignes().at(ligne_id).getNumero();
-            if (p_afficherItineraire)
-                cout << "De cette station, prenez l'autobus numéro " << ligne_numero << " à l'heure " << heure << " "
-                     << p_gtfs.getVoyages().at(voyage_id_a) << endl;
-            //maintenant allons à la dernière station de ce voyage
-            ptr_a = ptr_b;
-            ++sommet;
-            ptr_b = m_arretDuSommet.at(chemin[sommet]);
-            while (ptr_b->getVoyageId() == ptr_a->getVoyageId()) {
-                ptr_a = ptr_b;
-                ++sommet;
-                ptr_b = m_arretDuSommet.at(chemin[sommet]);
-            }
-            //on a changé de voyage
-            if (p_afficherItineraire)
-                cout << "et arrêtez-vous à la station " << p_gtfs.getStations().at(ptr_a->getStationId())
-                     << " à l'heure "
-                     << ptr_a->getHeureArrivee() << endl;
-            if (ptr_b->getStationId() == stationIdDestination) //cas où on est arrivé à la destination
-            {
-                if (sommet != chemin.size() - 1)
-                    throw logic_error(
-                            "ReseauGTFS::afficherItineraire(): incohérence de fin de chemin lors d'u changement de voyage");
-                break;
-            }
-            if (ptr_a->getStationId() != ptr_b->getStationId()) //alors on s'est rendu à pieds à l'autre station
-                if (p_afficherItineraire)
-                    cout << "De cette station, rendez-vous à pieds à la station "
-                         << p_gtfs.getStations().at(ptr_b->getStationId()) << endl;
+            if (sommet != p_chemin.size() - 1)
+                throw logic_error(
+                        "ReseauGTFS::reconstruireItineraire(): incohérence de fin de chemin lors d'un changement de voyage");
+            break;
+        }
+        if (a->getStationId() != b->getStationId()) //alors on s'est rendu à pieds à l'autre station
+            marche(a->getStationId(), b->getStationId());
+    }
+    marche(a->getStationId(), Itineraire::POINT_DESTINATION);
+}
+
+//! \brief Requête de profil: trouve tous les trajets Pareto-optimaux du point origine au point destination
+//! \brief pour un départ dans l'intervalle [p_debut, p_fin)
+//! \brief Une seule recherche (Dijkstra sur le graphe inversé à partir des arrêts des stations à distance de marche du
+//! \brief point destination, chacun avec son temps de marche) donne, pour chaque arrêt, l'heure d'arrivée au plus tôt à
+//! \brief destination. Ces étiquettes sont réutilisées pour toutes les heures de départ.
+//! \brief Le profil n'ajoute pas les points origine et destination au graphe: il ne modifie pas le réseau, de sorte que
+//! \brief le graphe inversé, construit au premier profil, sert aussi aux suivants.
+//! \param[in] p_gtfs: un objet DonneesGTFS
+//! \param[in] p_pointOrigine: les coordonnées GPS du point origine
+//! \param[in] p_pointDestination: les coordonnées GPS du point destination
+//! \param[in] p_debut: l'heure de début de l'intervalle de départ
+//! \param[in] p_fin: l'heure de fin de l'intervalle de départ
+//! \param[out] p_trajets: les trajets en ordre croissant d'heure de départ; aucun trajet n'est dominé par un autre
+//! \throws logic_error si aucun arrêt n'est à distance de marche du point destination ou si p_fin < p_debut
+void ReseauGTFS::profil(const DonneesGTFS &p_gtfs, const Coordonnees &p_pointOrigine,
+                        const Coordonnees &p_pointDestination, const Heure &p_debut, const Heure &p_fin,
+                        vector<TrajetProfil> &p_trajets) const {
+    verifierNumerotation(p_gtfs, "profil");
+    if (p_fin < p_debut)
+        throw logic_error("ReseauGTFS::profil(): l'intervalle de départ est invalide");
+
+    p_trajets.clear();
+
+    // Sources de la recherche inversée: les arrêts des stations à distance de marche du point destination
+    const map<unsigned int, Station> &m_stations = p_gtfs.getStations();
+    vector<pair<size_t, unsigned int> > sources;
+    for (auto station = m_stations.begin(); station != m_stations.end(); ++station) {
+        double distanceMarcheDestination = p_pointDestination - station->second.getCoords();
+        if (distanceMarcheDestination >= distanceMaxMarche) continue;
+
+        unsigned int tempsMarcheDestination = (distanceMarcheDestination / vitesseDeMarche) * 3600;
+        const Station::Arrets &arretsStation = station->second.getArrets();
+        for (auto arret = arretsStation.begin(); arret != arretsStation.end(); ++arret) {
+            sources.push_back({(*arret).second->getSommet(), tempsMarcheDestination});
         }
     }
+    if (sources.empty())
+        throw logic_error("ReseauGTFS::profil(): aucun arrêt de bus n'est dans le rayon maximal de marche de la destination");
+
+    vector<unsigned int> distance;
+    vector<size_t> successeur;
+    m_leGraphe.plusCourtsCheminsVers(sources, distance, successeur);
+
+    const Heure minuit(0, 0, 0);
+
+    // Candidats: (heure de départ du point origine, heure d'arrivée à destination, sommet du premier arrêt)
+    vector<tuple<int, int, size_t> > candidats;
 
-    if (p_afficherItineraire) {
-        cout << "Déplacez-vous à pieds de cette station au point destination" << endl;
-        cout << "Heure d'arrivée à la destination: " << p_gtfs.getTempsDebut().add_secondes(tempsDuTrajet) << endl;
+    for (auto station = m_stations.begin(); station != m_stations.end(); ++station) {
+        double distanceMarcheOrigine = p_pointOrigine - station->second.getCoords();
+        if (distanceMarcheOrigine >= distanceMaxMarche) continue;
+
+        unsigned int secondesMarche = ((distanceMarcheOrigine / vitesseDeMarche) * 3600);
+        const Station::Arrets &arretsStation = station->second.getArrets();
+
+        // Seuls les arrêts qu'on atteint en partant dans [p_debut, p_fin) sont des premiers arrêts possibles
+        auto arret = arretsStation.lower_bound(p_debut.add_secondes(secondesMarche));
+        auto fin = arretsStation.lower_bound(p_fin.add_secondes(secondesMarche));
+        for (; arret != fin; ++arret) {
+            size_t sommet = (*arret).second->getSommet();
+            if (distance[sommet] == numeric_limits<unsigned int>::max()) continue;
+
+            int heureArret = (*arret).first - minuit;
+            candidats.push_back(make_tuple(heureArret - (int) secondesMarche, heureArret + (int) distance[sommet], sommet));
+        }
     }
-    unsigned int h = tempsDuTrajet / 3600;
-    unsigned int reste_sec = tempsDuTrajet % 3600;
-    unsigned int m = reste_sec / 60;
-    unsigned int s = reste_sec % 60;
-    if (p_afficherItineraire) {
-        cout << "Durée du trajet: " << h << " heures, " << m << " minutes, " << s << " secondes" << endl;
+
+    // Balayage du départ le plus tardif au plus hâtif: un trajet est conservé ssi il arrive strictement plus tôt
+    // que tous les trajets partant plus tard
+    sort(candidats.begin(), candidats.end(), [](const tuple<int, int, size_t> &a, const tuple<int, int, size_t> &b) {
+        return get<0>(a) > get<0>(b) or (get<0>(a) == get<0>(b) and get<1>(a) < get<1>(b));
+    });
+
+    int meilleureArrivee = numeric_limits<int>::max();
+    for (auto candidat = candidats.begin(); candidat != candidats.end(); ++candidat) {
+        if (get<1>(*candidat) >= meilleureArrivee) continue;
+        meilleureArrivee = get<1>(*candidat);
+
+        TrajetProfil trajet;
+        trajet.heureDepart = minuit.add_secondes(get<0>(*candidat));
+        trajet.heureArrivee = minuit.add_secondes(get<1>(*candidat));
+        for (size_t sommet = get<2>(*candidat); sommet != numeric_limits<size_t>::max(); sommet = successeur[sommet]) {
+            trajet.chemin.push_back(sommet);
+        }
+        p_trajets.push_back(trajet);
     }
 
+    reverse(p_trajets.begin(), p_trajets.end());
 }
 
+//! \brief Calcule la matrice des temps de parcours (au plus tôt) de chaque station vers chaque station pour un départ à p_depart
+//! \brief Une recherche de type un-vers-tous est effectuée par station origine; les stations origines sont distribuées
+//! \brief dynamiquement entre p_nbThreads threads, chacun réutilisant son propre espace de recherche
+//! \brief Un thread ne prend une station origine qu'à moins de 2 * p_nbThreads lignes de la prochaine ligne à écrire:
+//! \brief un thread lent ne fait donc pas accumuler sans fin les lignes des autres en attente d'écriture
+//! \brief Le résultat est écrit au format CSV, dans l'ordre des stations: une ligne d'entête (identifiants des stations)
+//! \brief puis une ligne par station origine donnant le temps de parcours en secondes (vide si inatteignable)
+//! \param[in] p_gtfs: un objet DonneesGTFS
+//! \param[in] p_depart: l'heure de départ de chacune des stations origines
+//! \param[in] p_nbThreads: le nombre de threads à utiliser (0 pour le nombre de coeurs disponibles)
+//! \param[out] p_sortie: le flux de sortie où la matrice est écrite au fur et à mesure
+//! \throws logic_error si un problème survient durant le calcul
+void ReseauGTFS::matriceTempsDeParcours(const DonneesGTFS &p_gtfs, const Heure &p_depart, unsigned int p_nbThreads,
+                                        ostream &p_sortie) const {
+    verifierNumerotation(p_gtfs, "matriceTempsDeParcours");
+    const unsigned int aucuneStation = numeric_limits<unsigned int>::max();
+    vector<const Station *> stations;
+    vector<unsigned int> stationDuSommet;
+    numeroterStations(p_gtfs, stations, stationDuSommet);
+    const size_t nbStations = stations.size();
+
+    if (p_nbThreads == 0) p_nbThreads = max(1u, thread::hardware_concurrency());
+
+    p_sortie << "origine";
+    for (auto station : stations) p_sortie << "," << station->getId();
+    p_sortie << "\n";
+
+    const size_t fenetre = 2 * (size_t) p_nbThreads; //lignes prises ou en attente au-delà de la prochaine à écrire
+    mutex mutexSortie; //protège aussi prochaineOrigine
+    condition_variable ligneEcrite;
+    size_t prochaineOrigine = 0;
+    size_t prochaineLigneAEcrire = 0;
+    map<size_t, vector<unsigned int> > lignesEnAttente; //lignes calculées mais pas encore écrites (au plus fenetre)
+    exception_ptr erreur;
+
+    //prend la prochaine station origine, en attendant qu'elle soit dans la fenêtre; false lorsqu'il n'y en a plus
+    auto prendreOrigine = [&](size_t &p_origine) {
+        unique_lock<mutex> verrou(mutexSortie);
+        ligneEcrite.wait(verrou, [&]() {
+            return prochaineOrigine >= nbStations or prochaineOrigine < prochaineLigneAEcrire + fenetre;
+        });
+        if (prochaineOrigine >= nbStations) return false;
+        p_origine = prochaineOrigine++;
+        return true;
+    };
+
+    auto travailleur = [&]() {
+        Trace::Intervalle intervalle("travailleur de la matrice", "requete");
+        GrapheCompact::EspaceRecherche espace;
+        vector<pair<size_t, unsigned int> > sources;
+        try {
+            size_t origine;
+            while (prendreOrigine(origine)) {
+                // Sources: tous les arrêts de la station origine à partir de p_depart (on peut y attendre)
+                const Station::Arrets &arretsOrigine = stations[origine]->getArrets();
+                sources.clear();
+                for (auto arret = arretsOrigine.lower_bound(p_depart); arret != arretsOrigine.end(); ++arret) {
+                    sources.push_back({(*arret).second->getSommet(), (unsigned int) ((*arret).first - p_depart)});
+                }
+                m_leGraphe.plusCourtsCheminsDepuis(sources, espace);
+
+                vector<unsigned int> ligne(nbStations, numeric_limits<unsigned int>::max());
+                ligne[origine] = 0;
+                for (auto sommet : espace.sommetsAtteints) {
+                    unsigned int station = stationDuSommet[sommet];
+                    if (station != aucuneStation) ligne[station] = min(ligne[station], espace.distance[sommet]);
+                }
+
+                // Écriture dans l'ordre des stations des lignes consécutives disponibles
+                lock_guard<mutex> verrou(mutexSortie);
+                lignesEnAttente[origine].swap(ligne);
+                while (!lignesEnAttente.empty() and lignesEnAttente.begin()->first == prochaineLigneAEcrire) {
+                    const vector<unsigned int> &aEcrire = lignesEnAttente.begin()->second;
+                    p_sortie << stations[prochaineLigneAEcrire]->getId();
+                    for (auto temps : aEcrire) {
+                        p_sortie << ",";
+                        if (temps != numeric_limits<unsigned int>::max()) p_sortie << temps;
+                    }
+                    p_sortie << "\n";
+                    lignesEnAttente.erase(lignesEnAttente.begin());
+                    ++prochaineLigneAEcrire;
+                }
+                ligneEcrite.notify_all();
+            }
+        }
+        catch (...) {
+            lock_guard<mutex> verrou(mutexSortie);
+            if (!erreur) erreur = current_exception();
+            prochaineOrigine = nbStations;
+            ligneEcrite.notify_all();
+        }
+    };
 
+    vector<thread> threads;
+    for (unsigned int i = 1; i < p_nbThreads; ++i) threads.push_back(thread(travailleur));
+    travailleur();
+    for (auto &t : threads) t.join();
+
+    if (erreur) rethrow_exception(erreur);
+    p_sortie.flush();
+}
+
+//! \brief vérifie que les sommets des arrets de p_gtfs sont toujours ceux de ce réseau
+//! \param[in] p_methode: la méthode appelante, pour le message d'erreur
+//! \throws logic_error si un autre réseau construit sur p_gtfs, ou renumeroterSommets() d'une copie de ce réseau, les a
+//! \brief renumérotés (voir DonneesGTFS::nouvelleNumerotationSommets())
+void ReseauGTFS::verifierNumerotation(const DonneesGTFS &p_gtfs, const char *p_methode) const {
+    if (p_gtfs.getNumerotationSommets() != m_numerotationSommets)
+        throw logic_error(string("ReseauGTFS::") + p_methode +
+                          "(): un autre réseau construit sur ces données GTFS a renuméroté les sommets des arrets");
+}
+
+//! \brief numérote les stations de 0 à n-1 dans l'ordre de p_gtfs.getStations() et associe chaque sommet à sa station
+//! \param[out] p_stations: p_stations[k] est la station numéro k
+//! \param[out] p_stationDuSommet: p_stationDuSommet[i] est le numéro de la station du sommet i
+//! \post p_stationDuSommet[i] == numeric_limits<unsigned int>::max() pour les sommets origine et destination
+void ReseauGTFS::numeroterStations(const DonneesGTFS &p_gtfs, vector<const Station *> &p_stations,
+                                   vector<unsigned int> &p_stationDuSommet) const {
+    const map<unsigned int, Station> &m_stations = p_gtfs.getStations();
+
+    p_stations.clear();
+    for (auto station = m_stations.begin(); station != m_stations.end(); ++station) {
+        p_stations.push_back(&station->second);
+    }
+    p_stationDuSommet = m_stationDuSommet;
+    p_stationDuSommet.resize(m_leGraphe.getNbSommets(), numeric_limits<unsigned int>::max());
+}
+
+//! \brief Calcule les isochrones d'un point origine: pour chaque budget de temps, les stations atteignables (en autobus
+//! \brief ou à pieds) et le rayon qu'on peut encore parcourir à pieds autour de chacune
+//! \brief Une seule recherche un-vers-tous est effectuée; elle s'arrête dès que le plus grand budget est dépassé
+//! \brief Une station est atteinte au plus tôt de ses arrêts atteints, de l'arrivée à pieds du point origine et de
+//! \brief l'arrivée d'un transfert à pieds depuis une station voisine
+//! \param[in] p_gtfs: un objet DonneesGTFS
+//! \param[in] p_pointOrigine: les coordonnées GPS du point origine
+//! \param[in] p_depart: l'heure de départ du point origine
+//! \param[in] p_budgets: les budgets de temps, en secondes
+//! \param[out] p_isochrones: p_isochrones[k] contient les points atteignables avec le budget p_budgets[k]
+//! \post chaque isochrone débute par le point origine, suivi des stations en ordre d'identifiant
+void ReseauGTFS::isochrone(const DonneesGTFS &p_gtfs, const Coordonnees &p_pointOrigine, const Heure &p_depart,
+                           const vector<unsigned int> &p_budgets, vector<vector<PointIsochrone> > &p_isochrones) const {
+    verifierNumerotation(p_gtfs, "isochrone");
+    p_isochrones.assign(p_budgets.size(), vector<PointIsochrone>());
+    if (p_budgets.empty()) return;
+
+    const unsigned int budgetMax = *max_element(p_budgets.begin(), p_budgets.end());
+    const unsigned int inatteignable = numeric_limits<unsigned int>::max();
+
+    vector<const Station *> stations;
+    vector<unsigned int> stationDuSommet;
+    numeroterStations(p_gtfs, stations, stationDuSommet);
+
+    // Sources: les arrêts des stations accessibles à pieds du point origine
+    // On peut aussi se rendre à pieds à ces stations sans prendre l'autobus
+    vector<unsigned int> tempsStation(stations.size(), inatteignable);
+    vector<pair<size_t, unsigned int> > sources;
+    for (size_t k = 0; k < stations.size(); ++k) {
+        double distanceMarcheOrigine = p_pointOrigine - stations[k]->getCoords();
+        if (distanceMarcheOrigine >= distanceMaxMarche) continue;
+
+        unsigned int secondesMarche = ((distanceMarcheOrigine / vitesseDeMarche) * 3600);
+        tempsStation[k] = secondesMarche;
+
+        const Station::Arrets &arretsStation = stations[k]->getArrets();
+        for (auto arret = arretsStation.lower_bound(p_depart.add_secondes(secondesMarche));
+             arret != arretsStation.end(); ++arret) {
+            sources.push_back({(*arret).second->getSommet(), (unsigned int) ((*arret).first - p_depart)});
+        }
+    }
+
+    GrapheCompact::EspaceRecherche espace;
+    m_leGraphe.plusCourtsCheminsDepuis(sources, espace, budgetMax);
+
+    // tempsArret[k]: le plus tôt des arrêts atteints de la station k
+    vector<unsigned int> tempsArret(stations.size(), inatteignable);
+    for (auto sommet : espace.sommetsAtteints) {
+        unsigned int station = stationDuSommet[sommet];
+        if (station != inatteignable) tempsArret[station] = min(tempsArret[station], espace.distance[sommet]);
+    }
+    for (size_t k = 0; k < stations.size(); ++k) tempsStation[k] = min(tempsStation[k], tempsArret[k]);
+
+    // Un arc de transfert mène au prochain arrêt de la station voisine, mais on y est dès la fin de la marche: la
+    // station voisine est atteinte au plus tôt des arrêts de la station source, plus le temps de transfert
+    auto idInferieur = [](const Station *p_station, unsigned int p_id) { return p_station->getId() < p_id; };
+    auto numeroStation = [&stations, &idInferieur](unsigned int p_id) {
+        return (size_t) (lower_bound(stations.begin(), stations.end(), p_id, idInferieur) - stations.begin());
+    };
+    for (const auto &transfert : p_gtfs.getTransferts()) {
+        unsigned int depart = tempsArret[numeroStation(get<0>(transfert))];
+        if (depart == inatteignable) continue;
+        size_t arrivee = numeroStation(get<1>(transfert));
+        tempsStation[arrivee] = min(tempsStation[arrivee], depart + get<2>(transfert));
+    }
+
+    for (size_t b = 0; b < p_budgets.size(); ++b) {
+        const unsigned int budget = p_budgets[b];
+        double rayonOrigine = min(distanceMaxMarche, vitesseDeMarche * budget / 3600);
+        p_isochrones[b].push_back({stationIdOrigine, p_pointOrigine, rayonOrigine});
+        for (size_t k = 0; k < stations.size(); ++k) {
+            if (tempsStation[k] > budget) continue;
+            double rayon = min(distanceMaxMarche, vitesseDeMarche * (budget - tempsStation[k]) / 3600);
+            p_isochrones[b].push_back({stations[k]->getId(), stations[k]->getCoords(), rayon});
+        }
+    }
+}
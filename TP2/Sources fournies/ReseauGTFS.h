@@ -7,41 +7,111 @@
 
 #include "DonneesGTFS.h"
 #include "graphe.h"
+#include "Itineraire.h"
 
 
+//! \brief Le réseau range le sommet de chaque arret dans l'Arret même (Arret::setSommet()): sur un même DonneesGTFS (ou
+//! \brief ses copies, qui partagent les arrets), un seul réseau et ses copies peuvent être utilisés à la fois. Construire
+//! \brief un autre réseau, ou renuméroter une copie, renumérote les arrets; les méthodes qui reçoivent le DonneesGTFS
+//! \brief lancent alors logic_error au lieu de lire des sommets qui ne sont plus les leurs.
 class ReseauGTFS
 {
 
 public:
-    ReseauGTFS(const DonneesGTFS &);
+    //! \brief un trajet de l'ensemble de Pareto (départ le plus tard, arrivée la plus tôt) retourné par profil()
+    struct TrajetProfil
+    {
+        Heure heureDepart; //heure de départ (la plus tardive) du point origine
+        Heure heureArrivee; //heure d'arrivée au point destination
+        std::vector<size_t> chemin; //sommets du graphe, du premier au dernier arrêt (suit la marche vers le point destination)
+    };
+
+    //! \brief un point d'une isochrone: une station atteinte et le rayon qu'on peut encore parcourir à pieds autour d'elle
+    struct PointIsochrone
+    {
+        unsigned int stationId; //la station atteinte (stationIdOrigine pour le point origine lui-même)
+        Coordonnees coords; //les coordonnées GPS du point
+        double rayonMarche; //le rayon, en km, encore accessible à pieds dans le budget de temps
+    };
+
+    //! \brief l'effort d'une recherche d'itinéraire (voir dureeItineraire())
+    typedef GrapheCompact::StatistiquesRecherche StatistiquesRecherche;
+
+    //! \brief les moteurs de recherche d'itinéraire; tous sont exacts et doivent trouver la même durée (voir differentiel)
+    //! \brief Aux deux TP, les recherches d'itinéraires (itineraire(), trouverItineraire(), dureeItineraire(), lot, serveur)
+    //! \brief passent par plusCourtCheminElague() de graphe.h: la liste du TP2, en O(V²), est trop lente pour ces outils.
+    //! \brief plusCourtChemin() de graphe.cpp (liste au TP2, monceau au TP3) reste accessible par RechercheGraphe.
+    enum MoteurRecherche
+    {
+        RechercheDirecte, //plusCourtCheminElague() sans élagage, avec les arcs implicites vers la destination: le défaut
+        RechercheSansElagage, //plusCourtCheminElague() sans élagage, sur les arcs explicites vers la destination
+        RechercheGraphe //plusCourtChemin() de graphe.cpp, sur les arcs explicites vers la destination
+    };
+
+    explicit ReseauGTFS(const DonneesGTFS &, unsigned int = 0);
+    ReseauGTFS(const DonneesGTFS &, const std::string &);
+    void renumeroterSommets(const DonneesGTFS &);
+    void sauvegarderImage(const DonneesGTFS &, const std::string &) const;
+    void appliquerRetards(const DonneesGTFS &, const std::vector<Arret::Ptr> &);
     void ajouterArcsOrigineDestination(const DonneesGTFS &, const Coordonnees &, const Coordonnees &);
+    void ajouterArcsOrigineDestination(const DonneesGTFS &, const Coordonnees &, const Coordonnees &, const Heure &);
+    void ajouterArcsOrigineDestinations(const DonneesGTFS &, const Coordonnees &, const std::vector<Coordonnees> &);
+    void ajouterArcsOrigineDestinations(const DonneesGTFS &, const Coordonnees &, const std::vector<Coordonnees> &,
+                                        const Heure &);
+    void expliciterArcsVersDestination(const DonneesGTFS &);
     void enleverArcsOrigineDestination();
     void itineraire(const DonneesGTFS &, bool, long &) const;
+    void itineraires(const DonneesGTFS &, bool, long &) const;
+    Itineraire trouverItineraire() const;
+    void trouverItineraires(std::vector<Itineraire> &) const;
+    unsigned int dureeItineraire() const;
+    unsigned int dureeItineraire(StatistiquesRecherche &) const;
+    unsigned int dureeItineraire(MoteurRecherche) const;
+    void profil(const DonneesGTFS &, const Coordonnees &, const Coordonnees &, const Heure &, const Heure &,
+                std::vector<TrajetProfil> &) const;
+    void matriceTempsDeParcours(const DonneesGTFS &, const Heure &, unsigned int, std::ostream &) const;
+    void isochrone(const DonneesGTFS &, const Coordonnees &, const Heure &, const std::vector<unsigned int> &,
+                   std::vector<std::vector<PointIsochrone> > &) const;
     size_t getNbArcsOrigineVersStations() const;
     size_t getNbArcsStationsVersDestination() const;
+    size_t getNbArcs() const;
     double getDistMaxMarche() const;
-
+    void bilanMemoire(std::vector<PosteMemoire> &) const;
 
 private:
-    Graphe m_leGraphe;
-    std::vector<Arret::Ptr> m_arretDuSommet; //m_arretDuSommet[i] est le pointeur (shared_ptr) de l'arret (associé au sommet i du graphe
-    std::unordered_map<Arret::Ptr,size_t> m_sommetDeArret; //m_sommetDeArret[a_ptr] est le sommet du graphe associé au pointeur de l'arret a_ptr
-    std::vector<size_t> m_sommetsVersDestination; //Chaque élément est un sommet possédant un arc vers la destination
+    GrapheCompact m_leGraphe; //sommets et poids sur 32 bits
+    std::shared_ptr<const char> m_image; //image du réseau projetée en mémoire (vide si le graphe a été construit)
+    std::vector<Arret::Ptr> m_arretDuSommet; //m_arretDuSommet[i] est le pointeur (shared_ptr) de l'arret (associé au sommet i du graphe); a_ptr->getSommet() donne l'inverse
+    std::vector<unsigned int> m_voyageDuSommet; //m_voyageDuSommet[i] est le numéro (ordre de getVoyages()) du voyage de l'arret du sommet i
+    std::vector<unsigned int> m_stationDuSommet; //m_stationDuSommet[i] est le numéro (ordre de getStations()) de la station de l'arret du sommet i
+    std::vector<std::vector<std::pair<size_t, unsigned int> > > m_arcsVersDestination; //m_arcsVersDestination[s]: paires (point destination, secondes de marche) de la station s
+    std::vector<unsigned int> m_stationsVersDestination; //les stations dont l'entrée de m_arcsVersDestination est non vide
+    std::vector<std::pair<size_t, size_t> > m_arcsExplicites; //les arcs (arrêt, point destination) ajoutés au graphe par expliciterArcsVersDestination()
+    unsigned int m_numerotationSommets; //la numérotation des sommets des arrets établie par ce réseau (voir DonneesGTFS)
 
     bool m_origine_dest_ajoute; //indique si on a ajouté le point origine, le point destination, et les arcs correspondants
     size_t m_sommetOrigine; //le sommet du graphe qui représente le point d'origine
-    size_t m_sommetDestination; //le sommet du graphe qui représente le point destination
+    Heure m_heureDepart; //l'heure de départ du point d'origine
+    size_t m_sommetDestination; //le sommet du graphe qui représente le (premier) point destination
+    std::vector<size_t> m_sommetsDestination; //les sommets du graphe qui représentent chacun des points destination
     size_t m_nbArcsOrigineVersStations; //le nombre d'arcs du point origine vers des stations
-    size_t m_nbArcsStationsVersDestination; //le nombre d'arcs d'une station vers le point destination
+    size_t m_nbArcsStationsVersDestination; //le nombre d'arcs (implicites) d'un arrêt vers un point destination
 
     const double vitesseDeMarche = 5.0; // vitesse moyenne de marche, en km/heure, d'un humain selon wikipedia */
     const double distanceMaxMarche = 1.5; // distance maximale de marche permise, en km
     const unsigned int stationIdOrigine = 0; //numéro de stationID donné pour l'arret fantôme de départ
     const unsigned int stationIdDestination = 1; //numéro de stationID donné pour les arrets fantômes de destination
 
-    void ajouterArcsVoyages(const DonneesGTFS &); //ajout des arcs dus aux voyages
-    void ajouterArcsAttentes(const DonneesGTFS &); //ajout des arcs dus aux attentes à une station (arcs temporels)
-    void ajouterArcsTransferts(const DonneesGTFS &); //ajout des arcs dus aux transferts
+    void ajouterArcsVoyages(const DonneesGTFS &, unsigned int, std::vector<std::vector<GrapheCompact::ArcAAjouter> > &); //ajout des arcs dus aux voyages
+    void ajouterArcsAttentes(const DonneesGTFS &, unsigned int, std::vector<std::vector<GrapheCompact::ArcAAjouter> > &); //ajout des arcs dus aux attentes à une station (arcs temporels)
+    void ajouterArcsTransferts(const DonneesGTFS &, unsigned int, std::vector<std::vector<GrapheCompact::ArcAAjouter> > &); //ajout des arcs dus aux transferts
+    unsigned int rechercherChemin(std::vector<size_t> &) const; //plus court chemin vers le premier point destination
+    template<typename Statistiques>
+    unsigned int rechercherChemin(MoteurRecherche, std::vector<size_t> &, Statistiques &) const; //avec un moteur donné
+    void rechercherChemins(std::vector<std::vector<size_t> > &, std::vector<unsigned int> &) const; //vers chaque point destination
+    void reconstruireItineraire(const std::vector<size_t> &, unsigned int, Itineraire &) const; //étapes d'un chemin
+    void numeroterStations(const DonneesGTFS &, std::vector<const Station *> &, std::vector<unsigned int> &) const; //station de chaque sommet
+    void verifierNumerotation(const DonneesGTFS &, const char *) const; //les sommets des arrets sont-ils les nôtres?
 
 };
 
@@ -0,0 +1,116 @@
+//
+// Publication d'instantanés (données GTFS + réseau) remplaçables sans interrompre les requêtes
+//
+
+#include "ReseauPublie.h"
+
+using namespace std;
+
+//! \brief charge les données GTFS du dossier p_dossier, comme le font les programmes main
+//! \throws logic_error si un fichier ne peut être lu ou si aucun service n'est offert à la date
+DonneesGTFS chargerDonneesGTFS(const std::string &p_dossier, const Date &p_date, const Heure &p_debut,
+                               const Heure &p_fin) {
+    DonneesGTFS donnees(p_date, p_debut, p_fin);
+    donnees.ajouterLignes(p_dossier + "/routes.txt");
+    donnees.ajouterStations(p_dossier + "/stops.txt");
+    donnees.ajouterServices(p_dossier + "/calendar_dates.txt");
+    if (donnees.getNbServices() == 0)
+        throw logic_error("chargerDonneesGTFS(): On doit avoir nb_services > 0 pour continuer");
+    donnees.ajouterVoyagesDeLaDate(p_dossier + "/trips.txt");
+    donnees.ajouterArretsDesVoyagesDeLaDate(p_dossier + "/stop_times.txt");
+    donnees.ajouterTransferts(p_dossier + "/transfers.txt");
+    return donnees;
+}
+
+//! \brief charge les données GTFS du dossier p_dossier puis construit et renumérote le réseau
+//! \param[in] p_dossier: le dossier contenant les fichiers GTFS (routes.txt, stops.txt, etc.)
+//! \param[in] p_date: la date des voyages
+//! \param[in] p_debut, p_fin: l'intervalle de temps [p_debut, p_fin) des arrets chargés
+//! \param[in] p_nbThreads: le nombre de threads utilisés pour construire le réseau (0 pour tous les coeurs)
+//! \throws logic_error si un fichier ne peut être lu ou si aucun service n'est offert à la date
+InstantaneReseau::InstantaneReseau(const std::string &p_dossier, const Date &p_date, const Heure &p_debut,
+                                   const Heure &p_fin, unsigned int p_nbThreads)
+        : donnees(chargerDonneesGTFS(p_dossier, p_date, p_debut, p_fin)), reseau(donnees, p_nbThreads) {
+    reseau.renumeroterSommets(donnees);
+}
+
+PublicationReseau::PublicationReseau()
+        : m_version(0), m_nbRetires(0), m_arret(false), m_destructeur(&PublicationReseau::detruireRetires, this) {
+}
+
+//! \brief retire l'instantané courant puis attend que le thread de destruction ait détruit tous les retirés
+PublicationReseau::~PublicationReseau() {
+    publier(Ptr());
+    {
+        lock_guard<mutex> verrou(m_mutexRetires);
+        m_arret = true;
+    }
+    m_aDetruireNonVide.notify_one();
+    m_destructeur.join();
+}
+
+//! \brief retourne l'instantané courant (vide si aucun n'a été publié)
+//! \brief l'instantané reste valide tant que le pointeur retourné (ou une copie) existe, même s'il est remplacé
+PublicationReseau::Ptr PublicationReseau::obtenir() const {
+    return atomic_load(&m_courant);
+}
+
+//! \brief retourne le nombre d'instantanés publiés jusqu'ici
+unsigned long PublicationReseau::getVersion() const {
+    return m_version.load();
+}
+
+//! \brief publie p_instantane: les requêtes suivantes l'obtiendront, celles en cours terminent sur l'ancien
+//! \post l'ancien instantané est retiré; il sera détruit dès que plus aucune requête ne le détient
+void PublicationReseau::publier(const Ptr &p_instantane) {
+    Ptr publie;
+    if (p_instantane) publie = Ptr(p_instantane.get(), Liberation{this, p_instantane});
+    Ptr ancien;
+    {
+        lock_guard<mutex> verrou(m_mutexRetires);
+        ancien = atomic_exchange(&m_courant, publie);
+        ++m_version;
+        if (ancien) ++m_nbRetires;
+    }
+    //ancien est relâché hors du verrou: s'il en était le dernier détenteur, Liberation verrouille m_mutexRetires
+}
+
+//! \brief construit un instantané par p_construction dans un autre thread, puis le publie
+//! \return un future qui devient prêt une fois l'instantané publié (et qui relance l'exception de la construction)
+std::future<void> PublicationReseau::publierEnArrierePlan(const std::function<Ptr()> &p_construction) {
+    return async(launch::async, [this, p_construction]() {
+        publier(p_construction());
+    });
+}
+
+//! \brief retourne le nombre d'instantanés retirés qui n'ont pas encore été détruits
+size_t PublicationReseau::getNbRetires() const {
+    lock_guard<mutex> verrou(m_mutexRetires);
+    return m_nbRetires;
+}
+
+//! \brief appelé par le dernier détenteur d'un pointeur publié: la copie d'instantane est déplacée vers m_aDetruire
+//! \brief pour que ce soit le thread de destruction, et non la requête qui relâche le pointeur, qui la détruise
+void PublicationReseau::Liberation::operator()(const InstantaneReseau *) {
+    {
+        lock_guard<mutex> verrou(publication->m_mutexRetires);
+        publication->m_aDetruire.push_back(move(instantane));
+    }
+    publication->m_aDetruireNonVide.notify_one();
+}
+
+//! \brief boucle du thread de destruction: détruit les instantanés de m_aDetruire hors du verrou, jusqu'à m_arret
+void PublicationReseau::detruireRetires() {
+    unique_lock<mutex> verrou(m_mutexRetires);
+    for (;;) {
+        m_aDetruireNonVide.wait(verrou, [this]() { return !m_aDetruire.empty() or m_arret; });
+        if (m_aDetruire.empty()) return;
+        vector<Ptr> lot;
+        lot.swap(m_aDetruire);
+        const size_t nbDetruits = lot.size();
+        verrou.unlock();
+        lot.clear(); //détruit les instantanés dont le thread de destruction détient la dernière copie
+        verrou.lock();
+        m_nbRetires -= nbDetruits;
+    }
+}
@@ -0,0 +1,114 @@
+//
+// Arène d'allocation par blocs et allocateur qui y puise (données GTFS chargées, listes d'adjacence du graphe)
+//
+
+#ifndef RTC_ARENE_H
+#define RTC_ARENE_H
+
+#include <map>
+#include <memory>
+#include <vector>
+#include <mutex>
+#include <atomic>
+#include <type_traits>
+
+/*!
+ * \class Arene
+ * \brief Réserve la mémoire par grands blocs et la distribue par avancement d'un pointeur, sans verrou.
+ * \brief Les blocs ne sont rendus au système qu'à la destruction de l'arène, d'un coup: des dizaines de milliers de
+ * \brief petits objets (arrêts, noeuds d'arbres, listes d'adjacence) coûtent quelques appels à operator new au lieu
+ * \brief d'un malloc et d'un free chacun, et ceux qui sont alloués ensemble sont voisins en mémoire.
+ * \brief La mémoire d'un objet détruit est gardée dans une liste par taille et alignement, et resservie au prochain
+ * \brief objet de même taille et de même alignement: le noeud d'un arrêt que DonneesGTFS::appliquerRetards() retire
+ * \brief de sa station puis y remet, ou l'ancien tableau d'une liste d'adjacence qui grandit, ne font donc pas croître
+ * \brief l'arène à chaque modification. Ces listes ne sont consultées que lorsque de la mémoire a été rendue: le
+ * \brief chargement, qui ne rend à peu près rien, ne paie ni verrou ni recherche.
+ * \pre allouer() n'est appelé que par un thread à la fois, celui qui construit ou modifie les objets de l'arène;
+ * \pre recycler() peut l'être par n'importe quel thread (ex.: celui qui détruit le dernier Arret::Ptr d'un arrêt)
+ * \note elle convient aux données chargées d'un coup puis modifiées à la marge, pas aux objets de tailles toujours
+ * \note différentes
+ */
+class Arene
+{
+public:
+    explicit Arene(size_t p_tailleBloc = 256 * 1024);
+    ~Arene();
+    Arene(const Arene &) = delete;
+    Arene &operator=(const Arene &) = delete;
+
+    void *allouer(size_t p_octets, size_t p_alignement);
+    void recycler(void *p_objet, size_t p_octets, size_t p_alignement);
+    size_t getOctetsReserves() const;
+    size_t getOctetsUtilises() const;
+    size_t getNbBlocs() const;
+
+private:
+    size_t m_tailleBloc;
+    std::vector<char *> m_blocs;
+    char *m_courant; //le prochain octet libre du bloc courant
+    char *m_fin; //la fin du bloc courant
+    size_t m_octetsReserves;
+    size_t m_octetsUtilises;
+
+    std::atomic<bool> m_aDesRecycles; //vrai lorsque m_recycles n'est peut-être pas vide; lu sans verrou par allouer()
+    std::mutex m_mutexRecycles; //protège m_recycles, que recycler() peut modifier depuis un autre thread
+    //m_recycles[{octets, alignement}]: la tête de la liste des objets rendus de cette taille; chacun contient l'adresse
+    //du suivant (nullptr pour le dernier)
+    std::map<std::pair<size_t, size_t>, void *> m_recycles;
+
+    void *reprendreRecycle(size_t p_octets, size_t p_alignement);
+};
+
+/*!
+ * \class AllocateurArene
+ * \brief Allocateur qui puise dans une Arene, qu'il garde en vie: un conteneur ou un shared_ptr (allocate_shared)
+ * \brief qui l'utilise peut survivre à l'objet qui a créé l'arène.
+ * \brief Construit sans arène, il délègue à std::allocator: un même type de conteneur peut ainsi avoir ses éléments
+ * \brief dans une arène ou sur le tas.
+ * \brief Il suit son conteneur lors d'un déplacement ou d'un échange. Une copie de conteneur, elle, est sur le tas, et
+ * \brief une affectation par copie garde l'allocateur de sa destination: les copies (ex.: le réseau de chaque travailleur
+ * \brief du serveur) ne puisent jamais dans l'arène du chargement, qu'un seul thread à la fois peut remplir.
+ */
+template<typename T>
+class AllocateurArene
+{
+public:
+    typedef T value_type;
+    typedef std::false_type propagate_on_container_copy_assignment;
+    typedef std::true_type propagate_on_container_move_assignment;
+    typedef std::true_type propagate_on_container_swap;
+
+    AllocateurArene() {}
+    explicit AllocateurArene(const std::shared_ptr<Arene> &p_arene) : m_arene(p_arene) {}
+    template<typename U>
+    AllocateurArene(const AllocateurArene<U> &p_autre) : m_arene(p_autre.m_arene) {}
+
+    //! \brief une copie de conteneur est sur le tas
+    AllocateurArene select_on_container_copy_construction() const { return AllocateurArene(); }
+
+    T *allocate(size_t p_n)
+    {
+        if (!m_arene) return std::allocator<T>().allocate(p_n);
+        return static_cast<T *>(m_arene->allouer(p_n * sizeof(T), alignof(T)));
+    }
+
+    //! \brief dans une arène, la mémoire est recyclée pour la prochaine demande de même taille (voir Arene)
+    void deallocate(T *p_objets, size_t p_n)
+    {
+        if (!m_arene) std::allocator<T>().deallocate(p_objets, p_n);
+        else m_arene->recycler(p_objets, p_n * sizeof(T), alignof(T));
+    }
+
+    const std::shared_ptr<Arene> &getArene() const { return m_arene; }
+
+    template<typename U>
+    bool operator==(const AllocateurArene<U> &p_autre) const { return m_arene == p_autre.m_arene; }
+    template<typename U>
+    bool operator!=(const AllocateurArene<U> &p_autre) const { return m_arene != p_autre.m_arene; }
+
+private:
+    template<typename U> friend class AllocateurArene;
+    std::shared_ptr<Arene> m_arene; //nullptr: le tas
+};
+
+#endif //RTC_ARENE_H
@@ -0,0 +1,370 @@
+//
+// Harnais différentiel des moteurs de recherche d'itinéraires: les mêmes requêtes tirées au hasard passent par chaque
+// moteur, qui doit trouver la même durée que l'oracle, et le temps de recherche des moteurs est comparé
+// Une seule source pour les deux TP: le CMakeLists.txt du TP3 compile ce fichier avec son propre graphe.cpp
+//
+
+#include <iostream>
+#include <iomanip>
+#include <fstream>
+#include <sstream>
+#include <random>
+#include <chrono>
+#include <algorithm>
+#include <limits>
+#include <cstdlib>
+
+#include "DonneesGTFS.h"
+#include "ReseauGTFS.h"
+#include "ReseauPublie.h"
+#include "Echantillonnage.h"
+
+using namespace std;
+
+//! \brief un moteur comparé: son nom et la recherche de ReseauGTFS qu'il emploie
+struct Moteur
+{
+    string nom;
+    ReseauGTFS::MoteurRecherche recherche;
+};
+
+//! \brief la façon de tirer les points d'une requête
+enum Tirage
+{
+    PaireDeStations, //deux stations dont la distance est dans [distanceMin, distanceMax)
+    PointsAuHasard, //deux points au hasard dans l'enveloppe des stations, parfois loin de tout arrêt
+    MemeStation //l'origine et la destination sont une même station
+};
+
+//! \brief une catégorie de requêtes et son poids dans le mélange tiré au hasard
+struct Categorie
+{
+    string nom;
+    unsigned int poids;
+    Tirage tirage;
+    double distanceMin; //km, pour PaireDeStations
+    double distanceMax;
+    unsigned int departMin; //intervalle des heures de départ, en secondes après minuit
+    unsigned int departMax;
+};
+
+//! \brief une requête tirée au hasard
+struct Requete
+{
+    Requete(const string &p_categorie, const Coordonnees &p_origine, const Coordonnees &p_destination,
+            const Heure &p_depart)
+            : categorie(p_categorie), origine(p_origine), destination(p_destination), depart(p_depart) {}
+    string categorie;
+    Coordonnees origine;
+    Coordonnees destination;
+    Heure depart;
+};
+
+//! \brief les résultats d'un moteur pour chaque requête: la durée trouvée, en secondes ("inatteignable" ou "erreur"
+//! \brief s'il y a lieu), et le temps de recherche, en microsecondes
+struct Colonne
+{
+    string nom;
+    vector<string> durees;
+    vector<double> microsecondes;
+};
+
+//! \brief décrit la requête par les champs categorie,lat_origine,lon_origine,lat_destination,lon_destination,depart
+//! \brief du fichier de résultats: deux exécutions ont tiré les mêmes requêtes si leurs descriptions sont égales
+string decrire(const Requete &p_requete)
+{
+    ostringstream flux;
+    flux << fixed << setprecision(6) << p_requete.categorie << ',' << p_requete.origine.getLatitude() << ','
+         << p_requete.origine.getLongitude() << ',' << p_requete.destination.getLatitude() << ','
+         << p_requete.destination.getLongitude() << ',' << p_requete.depart;
+    return flux.str();
+}
+
+//! \brief tire les points et l'heure de départ d'une requête de la catégorie et l'ajoute à p_requetes
+//! \return false si aucune paire de stations de la catégorie n'a été trouvée (elle ne s'applique pas à ce réseau)
+bool tirerRequete(const Categorie &p_categorie, const vector<const Station *> &p_stations,
+                  const Coordonnees &p_coinMin, const Coordonnees &p_coinMax, mt19937 &p_generateur,
+                  vector<Requete> &p_requetes)
+{
+    if (p_categorie.tirage == PointsAuHasard)
+    {
+        uniform_real_distribution<double> latitude(p_coinMin.getLatitude(), p_coinMax.getLatitude());
+        uniform_real_distribution<double> longitude(p_coinMin.getLongitude(), p_coinMax.getLongitude());
+        double latitudeOrigine = latitude(p_generateur);
+        const Coordonnees origine(latitudeOrigine, longitude(p_generateur));
+        double latitudeDestination = latitude(p_generateur);
+        const Coordonnees destination(latitudeDestination, longitude(p_generateur));
+        p_requetes.push_back(Requete(p_categorie.nom, origine, destination,
+                                     tirerHeure(p_categorie.departMin, p_categorie.departMax, p_generateur)));
+        return true;
+    }
+    const Station *a = nullptr;
+    const Station *b = nullptr;
+    if (p_categorie.tirage == MemeStation)
+        a = b = p_stations[uniform_int_distribution<size_t>(0, p_stations.size() - 1)(p_generateur)];
+    else if (!tirerPaireDeStations(p_stations, p_categorie.distanceMin, p_categorie.distanceMax, p_generateur, a, b))
+        return false;
+    p_requetes.push_back(Requete(p_categorie.nom, a->getCoords(), b->getCoords(),
+                                 tirerHeure(p_categorie.departMin, p_categorie.departMax, p_generateur)));
+    return true;
+}
+
+//! \brief tire p_nbRequetes requêtes; la catégorie de chacune est tirée selon les poids de p_categories
+//! \brief Les requêtes ne dépendent que du germe et des données: le TP2 et le TP3 tirent les mêmes
+vector<Requete> tirerRequetes(const DonneesGTFS &p_donnees, const vector<Categorie> &p_categories,
+                              unsigned int p_nbRequetes, unsigned int p_germe)
+{
+    vector<const Station *> stations;
+    double latMin = numeric_limits<double>::max(), latMax = -latMin, lonMin = latMin, lonMax = -latMin;
+    for (const auto &station : p_donnees.getStations())
+    {
+        if (station.second.getArrets().empty()) continue;
+        stations.push_back(&station.second);
+        const Coordonnees &coords = station.second.getCoords();
+        latMin = min(latMin, coords.getLatitude()), latMax = max(latMax, coords.getLatitude());
+        lonMin = min(lonMin, coords.getLongitude()), lonMax = max(lonMax, coords.getLongitude());
+    }
+    if (stations.empty()) throw logic_error("tirerRequetes(): aucune station desservie");
+    const Coordonnees coinMin(latMin, lonMin), coinMax(latMax, lonMax);
+
+    vector<unsigned int> poids;
+    for (const Categorie &categorie : p_categories) poids.push_back(categorie.poids);
+    discrete_distribution<size_t> choix(poids.begin(), poids.end());
+
+    mt19937 generateur(p_germe);
+    vector<Requete> requetes;
+    requetes.reserve(p_nbRequetes);
+    while (requetes.size() < p_nbRequetes)
+    {
+        unsigned int essai = 0;
+        while (!tirerRequete(p_categories[choix(generateur)], stations, coinMin, coinMax, generateur, requetes))
+            if (++essai == 100) throw logic_error("tirerRequetes(): aucune catégorie ne s'applique à ce réseau");
+    }
+    return requetes;
+}
+
+//! \brief exécute p_requete avec chacun des moteurs, en commençant par le moteur p_premier (l'ordre tourne d'une
+//! \brief requête à l'autre: aucun moteur ne profite toujours des caches réchauffés par un autre)
+//! \brief Le moteur qui emploie les arcs implicites vers la destination (RechercheDirecte) est mesuré avant l'ajout
+//! \brief des arcs explicites, comme il est employé; les autres le sont ensuite, avec ces arcs.
+//! \brief Une recherche non mesurée précède les autres: sans elle, le premier groupe mesuré paie seul les défauts de
+//! \brief cache laissés par l'ajout des points, et le second profite de la région du graphe déjà parcourue.
+//! \param[out] p_durees: la durée trouvée par chaque moteur; "erreur" pour tous si aucun arrêt n'est à distance de marche
+//! \param[out] p_microsecondes: le temps de recherche de chaque moteur (l'ajout et le retrait des points exclus)
+void mesurer(const DonneesGTFS &p_donnees, ReseauGTFS &p_reseau, const Requete &p_requete,
+             const vector<Moteur> &p_moteurs, size_t p_premier, vector<string> &p_durees,
+             vector<double> &p_microsecondes)
+{
+    p_durees.assign(p_moteurs.size(), "erreur");
+    p_microsecondes.assign(p_moteurs.size(), 0);
+    try
+    {
+        p_reseau.ajouterArcsOrigineDestination(p_donnees, p_requete.origine, p_requete.destination,
+                                               p_requete.depart);
+    }
+    catch (const logic_error &)
+    {
+        return; //aucun arrêt à distance de marche
+    }
+    p_reseau.dureeItineraire(); //réchauffement
+    for (bool arcsExplicites : {false, true})
+    {
+        if (arcsExplicites) p_reseau.expliciterArcsVersDestination(p_donnees);
+        for (size_t k = 0; k < p_moteurs.size(); ++k)
+        {
+            size_t m = (p_premier + k) % p_moteurs.size();
+            bool arcsImplicites = p_moteurs[m].recherche == ReseauGTFS::RechercheDirecte;
+            if (arcsImplicites == arcsExplicites) continue;
+            auto debut = chrono::steady_clock::now();
+            unsigned int duree = p_reseau.dureeItineraire(p_moteurs[m].recherche);
+            auto fin = chrono::steady_clock::now();
+            p_microsecondes[m] = chrono::duration<double, micro>(fin - debut).count();
+            p_durees[m] = duree == numeric_limits<unsigned int>::max() ? "inatteignable" : to_string(duree);
+        }
+    }
+    p_reseau.enleverArcsOrigineDestination();
+}
+
+//! \brief écrit une ligne par requête et par moteur:
+//! \brief requete,categorie,lat_origine,lon_origine,lat_destination,lon_destination,depart,moteur,duree,microsecondes
+void ecrireResultats(const string &p_nomFichier, const vector<Requete> &p_requetes, const vector<Colonne> &p_colonnes)
+{
+    ofstream fichier(p_nomFichier);
+    if (!fichier.is_open()) throw logic_error("ecrireResultats(): impossible d'ouvrir " + p_nomFichier);
+    fichier << "requete,categorie,lat_origine,lon_origine,lat_destination,lon_destination,depart,moteur,duree,"
+            << "microsecondes\n";
+    for (size_t i = 0; i < p_requetes.size(); ++i)
+    {
+        const string description = decrire(p_requetes[i]);
+        for (const Colonne &colonne : p_colonnes)
+            fichier << i << ',' << description << ',' << colonne.nom << ',' << colonne.durees[i] << ','
+                    << colonne.microsecondes[i] << '\n';
+    }
+}
+
+//! \brief lit les colonnes d'un fichier écrit par ecrireResultats(), typiquement par l'autre TP; leurs noms sont
+//! \brief préfixés de "ref:"
+//! \throws logic_error si le fichier ne porte pas exactement sur les requêtes p_requetes
+vector<Colonne> lireReference(const string &p_nomFichier, const vector<Requete> &p_requetes)
+{
+    ifstream fichier(p_nomFichier);
+    if (!fichier.is_open()) throw logic_error("lireReference(): impossible d'ouvrir " + p_nomFichier);
+    vector<Colonne> colonnes;
+    string ligne;
+    getline(fichier, ligne); //l'en-tête
+    while (getline(fichier, ligne))
+    {
+        vector<string> champs;
+        stringstream flux(ligne);
+        string champ;
+        while (getline(flux, champ, ',')) champs.push_back(champ);
+        if (champs.size() != 10) throw logic_error("lireReference(): ligne mal formée: " + ligne);
+
+        size_t i = strtoul(champs[0].c_str(), nullptr, 10);
+        string description = champs[1];
+        for (size_t c = 2; c < 7; ++c) description += ',' + champs[c];
+        if (i >= p_requetes.size() or description != decrire(p_requetes[i]))
+            throw logic_error("lireReference(): " + p_nomFichier + " ne porte pas sur les mêmes requêtes "
+                              "(nombre de requêtes, germe ou données différents)");
+
+        const string nom = "ref:" + champs[7];
+        auto colonne = find_if(colonnes.begin(), colonnes.end(), [&nom](const Colonne &c) { return c.nom == nom; });
+        if (colonne == colonnes.end())
+        {
+            colonnes.push_back({nom, vector<string>(p_requetes.size()), vector<double>(p_requetes.size(), -1)});
+            colonne = colonnes.end() - 1;
+        }
+        colonne->durees[i] = champs[8];
+        colonne->microsecondes[i] = atof(champs[9].c_str());
+    }
+    for (const Colonne &colonne : colonnes)
+        if (find(colonne.microsecondes.begin(), colonne.microsecondes.end(), -1) != colonne.microsecondes.end())
+            throw logic_error("lireReference(): " + p_nomFichier + " ne porte pas sur les mêmes requêtes "
+                              "(nombre de requêtes, germe ou données différents)");
+    return colonnes;
+}
+
+//! \brief usage: differentiel [nb_requetes] [germe] [fichier_resultats] [fichier_reference]
+//! \brief par défaut: 100 requêtes, germe 1, differentiel.csv et aucune référence
+//! \brief Chaque requête passe par tous les moteurs de ce TP: dijkstra_<graphe.cpp> (plusCourtChemin(), "liste" au TP2,
+//! \brief "monceau" au TP3), sans_elagage et directe (plusCourtCheminElague(), le moteur par défaut). Le premier,
+//! \brief Dijkstra sans aucune optimisation, sert d'oracle. Le fichier de référence, écrit par une exécution de l'autre TP
+//! \brief avec le même nombre de requêtes et le même germe, ajoute ses moteurs à la comparaison; son premier moteur
+//! \brief devient l'oracle. Par exemple, pour comparer la liste du TP2 au monceau du TP3:
+//! \brief     (TP2) ./differentiel 100 1 liste.csv
+//! \brief     (TP3) ./differentiel 100 1 monceau.csv "../../TP2/Sources fournies/liste.csv"
+//! \return 0 si tous les moteurs trouvent les durées de l'oracle, 1 sinon
+int main(int argc, char *argv[])
+{
+    const string chemin_dossier = "RTC-8aout-1dec";
+    const Date today(2017, 8, 18);
+    const Heure now1(0, 0, 0);
+    const Heure now2(30, 0, 0);
+
+    unsigned int nbRequetes = argc > 1 ? (unsigned int) atoi(argv[1]) : 100;
+    unsigned int germe = argc > 2 ? (unsigned int) atoi(argv[2]) : 1;
+    string nomFichierResultats = argc > 3 ? argv[3] : "differentiel.csv";
+    string nomFichierReference = argc > 4 ? argv[4] : "";
+
+    DonneesGTFS donnees_rtc = chargerDonneesGTFS(chemin_dossier, today, now1, now2);
+    ReseauGTFS reseau_rtc(donnees_rtc);
+
+    //la fin du service: la dernière arrivée à une station
+    unsigned int finService = 0;
+    for (const auto &station : donnees_rtc.getStations())
+        if (!station.second.getArrets().empty())
+            finService = max(finService, (unsigned int) (station.second.getArrets().rbegin()->first - now1));
+
+    const double dMarche = reseau_rtc.getDistMaxMarche();
+    const unsigned int h = 3600;
+    //"tardive": départs peu avant la fin du service, souvent inatteignables; "points": souvent sans arrêt à distance de
+    //marche (erreur); "meme_station": la destination est à distance de marche nulle du point origine
+    const vector<Categorie> categories = {
+            {"courte",       30, PaireDeStations, 2.1 * dMarche, 5.0,                           7 * h, 19 * h},
+            {"moyenne",      25, PaireDeStations, 5.0,           10.0,                          7 * h, 19 * h},
+            {"traversee",    15, PaireDeStations, 10.0,          numeric_limits<double>::max(), 5 * h, 23 * h},
+            {"tardive",      10, PaireDeStations, 0.0,           numeric_limits<double>::max(), finService - 1800,
+                                                                                                finService - 600},
+            {"points",       15, PointsAuHasard,  0.0,           0.0,                           5 * h, 23 * h},
+            {"meme_station", 5,  MemeStation,     0.0,           0.0,                           5 * h, 23 * h}};
+    const vector<Requete> requetes = tirerRequetes(donnees_rtc, categories, nbRequetes, germe);
+
+    const vector<Moteur> moteurs = {
+            {string("dijkstra_") + GrapheCompact::getNomPlusCourtChemin(), ReseauGTFS::RechercheGraphe},
+            {"sans_elagage", ReseauGTFS::RechercheSansElagage},
+            {"directe", ReseauGTFS::RechercheDirecte}};
+
+    vector<Colonne> colonnes;
+    for (const Moteur &moteur : moteurs)
+        colonnes.push_back({moteur.nom, vector<string>(requetes.size()), vector<double>(requetes.size())});
+    vector<string> durees;
+    vector<double> microsecondes;
+    for (size_t i = 0; i < requetes.size(); ++i)
+    {
+        mesurer(donnees_rtc, reseau_rtc, requetes[i], moteurs, i % moteurs.size(), durees, microsecondes);
+        for (size_t m = 0; m < moteurs.size(); ++m)
+        {
+            colonnes[m].durees[i] = durees[m];
+            colonnes[m].microsecondes[i] = microsecondes[m];
+        }
+    }
+    ecrireResultats(nomFichierResultats, requetes, colonnes);
+
+    if (!nomFichierReference.empty())
+    {
+        vector<Colonne> reference = lireReference(nomFichierReference, requetes);
+        colonnes.insert(colonnes.begin(), reference.begin(), reference.end());
+    }
+
+    //les écarts à l'oracle, la première colonne
+    const Colonne &oracle = colonnes.front();
+    vector<unsigned int> nbEcarts(colonnes.size(), 0);
+    unsigned int nbEcartsTotal = 0;
+    for (size_t c = 1; c < colonnes.size(); ++c)
+    {
+        for (size_t i = 0; i < requetes.size(); ++i)
+        {
+            if (colonnes[c].durees[i] == oracle.durees[i]) continue;
+            ++nbEcarts[c];
+            if (++nbEcartsTotal > 10) continue; //seuls les premiers écarts sont affichés
+            cout << "ÉCART requête " << i << " (" << decrire(requetes[i]) << "): " << colonnes[c].nom << " = "
+                 << colonnes[c].durees[i] << ", " << oracle.nom << " = " << oracle.durees[i] << endl;
+        }
+    }
+
+    unsigned int nbAtteintes = 0, nbInatteignables = 0;
+    for (const string &duree : oracle.durees)
+    {
+        if (duree == "inatteignable") ++nbInatteignables;
+        else if (duree != "erreur") ++nbAtteintes;
+    }
+    cout << requetes.size() << " requêtes (germe " << germe << "): " << nbAtteintes << " atteintes, "
+         << nbInatteignables << " inatteignables, " << requetes.size() - nbAtteintes - nbInatteignables
+         << " sans arrêt à distance de marche" << endl;
+
+    //l'accélération de chaque moteur par rapport à l'oracle, sur le temps total de recherche; les percentiles omettent
+    //les requêtes sans arrêt à distance de marche, qui ne font aucune recherche
+    double totalOracle = 0;
+    for (double us : oracle.microsecondes) totalOracle += us;
+    cout << left << setw(24) << "moteur" << right << setw(12) << "total (ms)" << setw(12) << "p50 (us)"
+         << setw(12) << "p99 (us)" << setw(12) << "max (us)" << setw(15) << "accélération" << setw(10) << "écarts"
+         << endl;
+    for (size_t c = 0; c < colonnes.size(); ++c)
+    {
+        vector<double> triees;
+        for (size_t i = 0; i < requetes.size(); ++i)
+            if (colonnes[c].durees[i] != "erreur") triees.push_back(colonnes[c].microsecondes[i]);
+        sort(triees.begin(), triees.end());
+        double total = 0;
+        for (double us : triees) total += us;
+        cout << left << setw(24) << colonnes[c].nom << right << fixed << setprecision(1) << setw(12) << total / 1000
+             << setw(12) << percentile(triees, 50) << setw(12) << percentile(triees, 99) << setw(12)
+             << (triees.empty() ? 0 : triees.back()) << setprecision(2) << setw(12)
+             << (total > 0 ? totalOracle / total : 0) << "x" << setw(9) << nbEcarts[c] << endl;
+        cout.unsetf(ios::fixed);
+    }
+
+    cout << (nbEcartsTotal == 0 ? "CONCORDANCE" : "DISCORDANCE") << ": " << nbEcartsTotal << " écart(s) à l'oracle "
+         << oracle.nom << "; résultats écrits dans " << nomFichierResultats << endl;
+    return nbEcartsTotal == 0 ? 0 : 1;
+}
@@ -0,0 +1,375 @@
+//
+// Traitement par lot d'un fichier de requêtes origine-destination, réparties entre des threads travailleurs
+//
+
+#include <iostream>
+#include <fstream>
+#include <sstream>
+#include <string>
+#include <vector>
+#include <map>
+#include <thread>
+#include <mutex>
+#include <condition_variable>
+#include <chrono>
+#include <cstdlib>
+#include <cctype>
+#include <atomic>
+
+#include "DonneesGTFS.h"
+#include "ReseauGTFS.h"
+#include "ReseauPublie.h"
+#include "FileBornee.h"
+#include "RequeteOD.h"
+
+using namespace std;
+
+//! \brief un paquet de lignes consécutives du fichier de requêtes, la tâche d'un travailleur
+struct Paquet
+{
+    size_t numero; //rang du paquet dans le fichier, pour l'écriture dans l'ordre
+    vector<pair<size_t, string>> lignes; //(numéro de ligne dans le fichier, texte)
+};
+
+//! \brief fenêtre de réordonnancement: les paquets terminés y attendent que leurs prédécesseurs soient écrits
+//! \brief La lecture ne peut avoir plus de m_taille paquets d'avance sur l'écriture, ce qui borne la mémoire tenue
+//! \brief par les réponses en attente lorsqu'un paquet lent retient ceux qui le suivent.
+class FenetreOrdonnee
+{
+public:
+    explicit FenetreOrdonnee(size_t p_taille) : m_taille(p_taille), m_prochain(0), m_fermee(false), m_nbPaquets(0) {}
+
+    //! \brief bloque jusqu'à ce que le paquet p_numero entre dans la fenêtre
+    void attendrePlace(size_t p_numero)
+    {
+        unique_lock<mutex> verrou(m_mutex);
+        m_ecrit.wait(verrou, [this, p_numero]() { return p_numero < m_prochain + m_taille; });
+    }
+
+    void deposer(size_t p_numero, string p_reponses)
+    {
+        lock_guard<mutex> verrou(m_mutex);
+        m_termines[p_numero] = move(p_reponses);
+        m_depose.notify_one();
+    }
+
+    //! \brief plus aucun paquet ne sera déposé: le dernier paquet lu a le numéro p_nbPaquets - 1
+    void fermer(size_t p_nbPaquets)
+    {
+        lock_guard<mutex> verrou(m_mutex);
+        m_fermee = true;
+        m_nbPaquets = p_nbPaquets;
+        m_depose.notify_one();
+    }
+
+    //! \brief écrit les paquets dans l'ordre de leur numéro, au fur et à mesure qu'ils sont terminés
+    void ecrire(ostream &p_sortie)
+    {
+        unique_lock<mutex> verrou(m_mutex);
+        for (;;)
+        {
+            m_depose.wait(verrou, [this]() {
+                return m_termines.count(m_prochain) or (m_fermee and m_prochain == m_nbPaquets);
+            });
+            if (!m_termines.count(m_prochain)) return;
+            string reponses = move(m_termines[m_prochain]);
+            m_termines.erase(m_prochain);
+            verrou.unlock();
+            p_sortie << reponses;
+            verrou.lock();
+            ++m_prochain;
+            m_ecrit.notify_all();
+        }
+    }
+
+private:
+    const size_t m_taille;
+    size_t m_prochain; //numéro du prochain paquet à écrire
+    bool m_fermee;
+    size_t m_nbPaquets;
+    map<size_t, string> m_termines;
+    mutex m_mutex;
+    condition_variable m_depose;
+    condition_variable m_ecrit;
+};
+
+//! \brief écrit p_texte comme champ CSV entre guillemets (les guillemets internes sont doublés)
+void ecrireChampCsv(ostream &p_sortie, const string &p_texte)
+{
+    p_sortie << '"';
+    for (char c : p_texte)
+    {
+        if (c == '"') p_sortie << '"';
+        p_sortie << c;
+    }
+    p_sortie << '"';
+}
+
+//! \brief écrit une extrémité d'étape: "origine", "destination" ou l'identifiant de la station
+void ecrireExtremite(ostream &p_sortie, unsigned int p_station)
+{
+    if (p_station == Itineraire::POINT_ORIGINE) p_sortie << "origine";
+    else if (p_station == Itineraire::POINT_DESTINATION) p_sortie << "destination";
+    else p_sortie << p_station;
+}
+
+//! \brief écrit la ligne de sortie "ligne,statut,depart,arrivee,duree,correspondances,etapes" d'un itinéraire
+//! \brief etapes est une liste compacte séparée par " ; ": "marche de>a" ou "autobus ligne de>a montee>descente"
+void ecrireResultat(ostream &p_sortie, size_t p_ligne, const DonneesGTFS &p_donnees, const Itineraire &p_itineraire)
+{
+    static const char *const nomsStatuts[] = {"trouve", "inatteignable", "sur_place"};
+    p_sortie << p_ligne << "," << nomsStatuts[p_itineraire.statut] << "," << p_itineraire.heureDepart << ",";
+    if (p_itineraire.statut != Itineraire::Trouve)
+    {
+        p_sortie << ",,,\n";
+        return;
+    }
+
+    unsigned int nbAutobus = 0;
+    ostringstream etapes;
+    for (const EtapeItineraire &etape : p_itineraire.etapes)
+    {
+        if (&etape != &p_itineraire.etapes.front()) etapes << " ; ";
+        if (etape.mode == EtapeItineraire::Marche)
+        {
+            etapes << "marche ";
+        }
+        else
+        {
+            ++nbAutobus;
+            const Voyage &voyage = p_donnees.getVoyages().at(etape.montee->getVoyageId());
+            etapes << "autobus " << p_donnees.getLignes().at(voyage.getLigne()).getNumero() << " ";
+        }
+        ecrireExtremite(etapes, etape.stationDepart);
+        etapes << ">";
+        ecrireExtremite(etapes, etape.stationArrivee);
+        if (etape.mode == EtapeItineraire::Autobus)
+            etapes << " " << etape.montee->getHeureArrivee() << ">" << etape.descente->getHeureArrivee();
+    }
+    p_sortie << p_itineraire.getHeureArrivee() << "," << p_itineraire.duree << ","
+             << (nbAutobus > 1 ? nbAutobus - 1 : 0) << ",";
+    ecrireChampCsv(p_sortie, etapes.str());
+    p_sortie << "\n";
+}
+
+//! \brief lit les destinations supplémentaires d'une requête destinations: les paires lat,lon qui suivent son
+//! \brief septième champ
+//! \throws logic_error si un champ manque ou n'est pas numérique
+vector<Coordonnees> lireAutresDestinations(const vector<string> &p_champs)
+{
+    if (p_champs.size() % 2 != 1) throw logic_error("destinations: paires lat,lon attendues");
+    vector<Coordonnees> destinations;
+    try
+    {
+        for (size_t k = 7; k < p_champs.size(); k += 2)
+            destinations.push_back(Coordonnees(stod(p_champs[k]), stod(p_champs[k + 1])));
+    }
+    catch (const invalid_argument &)
+    {
+        throw logic_error("destinations: champ non numérique");
+    }
+    return destinations;
+}
+
+//! \brief écrit la ligne de sortie d'une requête de profil: "ligne,profil,debut,fin,,,trajets", où trajets est la liste
+//! \brief des trajets Pareto-optimaux "depart>arrivee" séparés par " ; " (voir ReseauGTFS::profil())
+//! \param[in] p_champs: les champs de la requête; le huitième, facultatif, est la fin de l'intervalle de départ (une
+//! \brief heure après le départ de la requête par défaut)
+void ecrireProfil(ostream &p_sortie, size_t p_ligne, const vector<string> &p_champs, const DonneesGTFS &p_donnees,
+                  const ReseauGTFS &p_reseau, const RequeteOD &p_requete)
+{
+    Heure fin = p_champs.size() > 7 ? lireHeure(p_champs[7]) : p_requete.depart.add_secondes(3600);
+    vector<ReseauGTFS::TrajetProfil> trajets;
+    p_reseau.profil(p_donnees, p_requete.origine, p_requete.destination, p_requete.depart, fin, trajets);
+
+    ostringstream liste;
+    for (const auto &trajet : trajets)
+    {
+        if (&trajet != &trajets.front()) liste << " ; ";
+        liste << trajet.heureDepart << ">" << trajet.heureArrivee;
+    }
+    p_sortie << p_ligne << ",profil," << p_requete.depart << "," << fin << ",,,";
+    ecrireChampCsv(p_sortie, liste.str());
+    p_sortie << "\n";
+}
+
+//! \brief écrit la ligne de sortie d'une requête d'isochrones: "ligne,isochrone,depart,,,,stations", où stations donne,
+//! \brief pour chaque budget, "budget:nombre de stations atteignables" séparés par " ; " (voir ReseauGTFS::isochrone())
+//! \param[in] p_champs: les champs de la requête; ceux qui suivent le septième sont les budgets en secondes (15, 30 et 45
+//! \brief minutes par défaut); la destination de la requête est ignorée
+void ecrireIsochrones(ostream &p_sortie, size_t p_ligne, const vector<string> &p_champs, const DonneesGTFS &p_donnees,
+                      const ReseauGTFS &p_reseau, const RequeteOD &p_requete)
+{
+    vector<unsigned int> budgets;
+    try
+    {
+        for (size_t k = 7; k < p_champs.size(); ++k) budgets.push_back(stoul(p_champs[k]));
+    }
+    catch (const invalid_argument &)
+    {
+        throw logic_error("isochrone: budget non numérique");
+    }
+    if (budgets.empty()) budgets = {900, 1800, 2700};
+    vector<vector<ReseauGTFS::PointIsochrone> > isochrones;
+    p_reseau.isochrone(p_donnees, p_requete.origine, p_requete.depart, budgets, isochrones);
+
+    ostringstream liste;
+    for (size_t k = 0; k < budgets.size(); ++k)
+    {
+        if (k > 0) liste << " ; ";
+        liste << budgets[k] << ":" << isochrones[k].size() - 1; //chaque isochrone débute par le point origine
+    }
+    p_sortie << p_ligne << ",isochrone," << p_requete.depart << ",,,,";
+    ecrireChampCsv(p_sortie, liste.str());
+    p_sortie << "\n";
+}
+
+//! \brief répond aux requêtes des paquets de p_file sur une copie du réseau propre au thread
+void travailleur(FileBornee<Paquet> &p_file, FenetreOrdonnee &p_fenetre, atomic<size_t> &p_nbErreurs,
+                 const InstantaneReseau &p_instantane, const Date &p_date, const Heure &p_debut, const Heure &p_fin)
+{
+    ReseauGTFS reseau(p_instantane.reseau);
+    Paquet paquet;
+    while (p_file.retirer(paquet))
+    {
+        ostringstream reponses;
+        for (const auto &ligne : paquet.lignes)
+        {
+            try
+            {
+                vector<string> champs = separerChamps(ligne.second);
+                RequeteOD requete = lireRequeteOD(champs);
+                verifierRequeteOD(requete, p_date, p_debut, p_fin);
+                string genre = champs.size() > 6 ? champs[6] : "itineraire";
+                if (genre == "itineraire")
+                    ecrireResultat(reponses, ligne.first, p_instantane.donnees,
+                                   itineraireRequeteOD(p_instantane.donnees, reseau, requete));
+                else if (genre == "destinations")
+                {
+                    //une ligne de sortie par destination, celle de la requête puis les autres, dans l'ordre
+                    for (const Itineraire &itineraire :
+                            itinerairesRequeteOD(p_instantane.donnees, reseau, requete, lireAutresDestinations(champs)))
+                        ecrireResultat(reponses, ligne.first, p_instantane.donnees, itineraire);
+                }
+                else if (genre == "isochrone")
+                    ecrireIsochrones(reponses, ligne.first, champs, p_instantane.donnees, reseau, requete);
+                else if (genre == "profil")
+                    ecrireProfil(reponses, ligne.first, champs, p_instantane.donnees, reseau, requete);
+                else
+                    throw logic_error("genre de requête inconnu: " + genre);
+            }
+            catch (const exception &e)
+            {
+                ++p_nbErreurs;
+                reponses << ligne.first << ",erreur,,,,,";
+                ecrireChampCsv(reponses, e.what());
+                reponses << "\n";
+            }
+        }
+        p_fenetre.deposer(paquet.numero, reponses.str());
+    }
+}
+
+//! \brief usage: lot fichier_requetes [fichier_sortie] [nb_threads] [AAAA-MM-JJ] [HH:MM:SS debut] [HH:MM:SS fin]
+//! \brief Chaque ligne de fichier_requetes est "lat_origine,lon_origine,lat_destination,lon_destination,AAAA-MM-JJ,
+//! \brief HH:MM:SS"; les lignes vides, celles qui commencent par # et une première ligne d'en-tête sont ignorées.
+//! \brief Le réseau est chargé une seule fois, pour la date et l'intervalle donnés (2017-08-18, 00:00:00 à 30:00:00
+//! \brief par défaut, comme le serveur), puis les requêtes sont réparties par paquets entre nb_threads travailleurs
+//! \brief (0, par défaut, pour tous les coeurs). Les résultats sont écrits dans fichier_sortie (- pour la sortie
+//! \brief standard, par défaut) dans l'ordre des requêtes, au fur et à mesure, sous la forme
+//! \brief "ligne,statut,depart,arrivee,duree,correspondances,etapes"; une requête invalide donne le statut erreur et
+//! \brief son message dans etapes.
+//! \brief Un septième champ, facultatif, donne le genre de la requête: itineraire (par défaut); profil, suivi alors
+//! \brief de la fin HH:MM:SS de l'intervalle de départ (voir ecrireProfil()); ou destinations, suivi des paires lat,lon
+//! \brief d'autres points destination, tous solutionnés en une seule recherche (une ligne de sortie par destination);
+//! \brief ou isochrone, suivi des budgets de temps en secondes (voir ecrireIsochrones()).
+int main(int argc, char *argv[])
+{
+    if (argc < 2)
+    {
+        cerr << "usage: " << argv[0]
+             << " fichier_requetes [fichier_sortie] [nb_threads] [AAAA-MM-JJ] [HH:MM:SS debut] [HH:MM:SS fin]" << endl;
+        return 1;
+    }
+    const string dossier = "RTC-8aout-1dec";
+    string nomFichierRequetes = argv[1];
+    string nomFichierSortie = argc > 2 ? argv[2] : "-";
+    unsigned int nbThreads = argc > 3 ? (unsigned int) atoi(argv[3]) : 0;
+    if (nbThreads == 0) nbThreads = max(1u, thread::hardware_concurrency());
+    Date date = argc > 4 ? lireDate(argv[4]) : Date(2017, 8, 18);
+    Heure debut = argc > 5 ? lireHeure(argv[5]) : Heure(0, 0, 0);
+    Heure fin = argc > 6 ? lireHeure(argv[6]) : Heure(30, 0, 0); //un voyage débuté avant minuit peut finir après
+
+    ifstream fichierRequetes;
+    if (nomFichierRequetes != "-")
+    {
+        fichierRequetes.open(nomFichierRequetes);
+        if (!fichierRequetes) throw logic_error("main(): impossible d'ouvrir " + nomFichierRequetes);
+    }
+    istream &requetes = nomFichierRequetes == "-" ? cin : fichierRequetes;
+    ofstream fichierSortie;
+    if (nomFichierSortie != "-")
+    {
+        fichierSortie.open(nomFichierSortie);
+        if (!fichierSortie) throw logic_error("main(): impossible de créer " + nomFichierSortie);
+    }
+    ostream &sortie = nomFichierSortie == "-" ? cout : fichierSortie;
+
+    auto t0 = chrono::steady_clock::now();
+    InstantaneReseau instantane(dossier, date, debut, fin, nbThreads);
+    auto t1 = chrono::steady_clock::now();
+    cerr << "Réseau chargé en " << chrono::duration<double>(t1 - t0).count() << " secondes; " << nbThreads
+         << " travailleurs" << endl;
+
+    const size_t taillePaquet = 64;
+    FileBornee<Paquet> file(2 * nbThreads);
+    FenetreOrdonnee fenetre(8 * nbThreads);
+    atomic<size_t> nbErreurs(0);
+    vector<thread> travailleurs;
+    for (unsigned int t = 0; t < nbThreads; ++t)
+        travailleurs.push_back(thread(travailleur, ref(file), ref(fenetre), ref(nbErreurs), cref(instantane),
+                                      cref(date), cref(debut), cref(fin)));
+    sortie << "ligne,statut,depart,arrivee,duree,correspondances,etapes\n";
+    thread ecrivain([&fenetre, &sortie]() { fenetre.ecrire(sortie); });
+
+    Paquet paquet;
+    paquet.numero = 0;
+    size_t numeroLigne = 0, nbRequetes = 0;
+    string ligne;
+    while (getline(requetes, ligne))
+    {
+        ++numeroLigne;
+        if (!ligne.empty() and ligne.back() == '\r') ligne.pop_back();
+        if (ligne.empty() or ligne[0] == '#') continue;
+        if (nbRequetes == 0 and !isdigit((unsigned char) ligne[0]) and string("+-.").find(ligne[0]) == string::npos)
+            continue; //en-tête: le premier champ n'est pas une latitude
+        paquet.lignes.push_back(make_pair(numeroLigne, ligne));
+        ++nbRequetes;
+        if (paquet.lignes.size() == taillePaquet)
+        {
+            size_t numero = paquet.numero;
+            fenetre.attendrePlace(numero);
+            file.ajouter(move(paquet));
+            paquet = Paquet();
+            paquet.numero = numero + 1;
+        }
+    }
+    size_t nbPaquets = paquet.numero;
+    if (!paquet.lignes.empty())
+    {
+        fenetre.attendrePlace(paquet.numero);
+        file.ajouter(move(paquet));
+        ++nbPaquets;
+    }
+    file.fermer();
+    for (auto &t : travailleurs) t.join();
+    fenetre.fermer(nbPaquets);
+    ecrivain.join();
+    sortie.flush();
+
+    auto t2 = chrono::steady_clock::now();
+    double secondes = chrono::duration<double>(t2 - t1).count();
+    cerr << nbRequetes << " requêtes (" << nbErreurs << " en erreur) traitées en " << secondes << " secondes ("
+         << (secondes > 0 ? nbRequetes / secondes : 0) << " requêtes/seconde)" << endl;
+    return 0;
+}
@@ -7,11 +7,18 @@
 
 #include "DonneesGTFS.h"
 #include "ReseauGTFS.h"
+#include "trace.h"
 
 using namespace std;
 
-int main()
+//! \brief usage: main [fichier_trace]
+//! \brief avec fichier_trace, le chargement, la construction du réseau et les requêtes y sont tracés (JSON « trace
+//! \brief event », à ouvrir avec chrome://tracing ou Perfetto)
+int main(int argc, char *argv[])
 {
+    string fichierTrace = argc > 1 ? argv[1] : "";
+    if (!fichierTrace.empty()) Trace::demarrer();
+
     const string chemin_dossier = "RTC-8aout-1dec";
     Date today(2017, 8, 18);
     Heure now1(8, 30, 0);
@@ -103,6 +110,12 @@ int main()
     cout << endl << "Temps d'exécution de l'algorithme de plus court chemin: " << tempsExecution2
          << " microsecondes" << endl;
 
+    if (!fichierTrace.empty())
+    {
+        Trace::ecrireFichier(fichierTrace);
+        cout << "Trace écrite dans " << fichierTrace << endl;
+    }
+
     return 0;
 }
 
@@ -0,0 +1,94 @@
+//
+// Calcul de la matrice des temps de parcours entre toutes les stations
+//
+
+#include <iostream>
+#include <fstream>
+#include <ctime>
+#include <chrono>
+#include <cstdlib>
+
+#include "DonneesGTFS.h"
+#include "ReseauGTFS.h"
+#include "trace.h"
+
+using namespace std;
+
+//! \brief usage: matrice [nb_threads] [fichier_sortie] [fichier_image] [fichier_trace]
+//! \brief nb_threads = 0 (par défaut) utilise tous les coeurs disponibles; le fichier de sortie est matrice.csv par défaut
+//! \brief si fichier_image existe, le graphe y est projeté en mémoire plutôt que construit; sinon il est construit puis sauvegardé
+//! \brief avec fichier_trace, le chargement et la construction du réseau y sont tracés, un thread par ligne (JSON « trace
+//! \brief event », à ouvrir avec chrome://tracing ou Perfetto); fichier_image peut être "" pour ne pas utiliser d'image
+int main(int argc, char *argv[])
+{
+    const string chemin_dossier = "RTC-8aout-1dec";
+    Date today(2017, 8, 18);
+    Heure now1(8, 30, 0);
+    Heure now2 = now1.add_secondes(72000); //on désire obtenir tous les arrêts du reste de la journée
+
+    unsigned int nbThreads = argc > 1 ? (unsigned int) atoi(argv[1]) : 0;
+    string nomFichierSortie = argc > 2 ? argv[2] : "matrice.csv";
+    string nomFichierImage = argc > 3 ? argv[3] : "";
+    string nomFichierTrace = argc > 4 ? argv[4] : "";
+    if (!nomFichierTrace.empty()) Trace::demarrer();
+
+    clock_t begin = clock();
+    DonneesGTFS donnees_rtc(today, now1, now2);
+    donnees_rtc.ajouterLignes(chemin_dossier + "/routes.txt");
+    donnees_rtc.ajouterStations(chemin_dossier + "/stops.txt");
+    donnees_rtc.ajouterServices(chemin_dossier + "/calendar_dates.txt");
+    if (donnees_rtc.getNbServices() == 0) throw logic_error("main(): On doit avoir nb_services > 0 pour continuer");
+    donnees_rtc.ajouterVoyagesDeLaDate(chemin_dossier + "/trips.txt");
+    donnees_rtc.ajouterArretsDesVoyagesDeLaDate(chemin_dossier + "/stop_times.txt");
+    donnees_rtc.ajouterTransferts(chemin_dossier + "/transfers.txt");
+    clock_t end = clock();
+    cout << "Chargement des données effectué en " << double(end - begin) / CLOCKS_PER_SEC << " secondes" << endl;
+    cout << "Nombre de stations ayant au moins 1 arret = " << donnees_rtc.getNbStations() << endl;
+
+    //clock() cumule le temps de tous les threads: on mesure plutôt le temps réel écoulé
+    const bool imageExiste = !nomFichierImage.empty() and ifstream(nomFichierImage).good();
+    auto debutGraphe = chrono::steady_clock::now();
+    ReseauGTFS reseau_rtc = imageExiste ? ReseauGTFS(donnees_rtc, nomFichierImage) : ReseauGTFS(donnees_rtc, nbThreads);
+    auto finGraphe = chrono::steady_clock::now();
+    cout << "Graphe (sans le point source et destination) a été " << (imageExiste ? "projeté en mémoire" : "produit")
+         << " en " << chrono::duration<double>(finGraphe - debutGraphe).count() << " secondes" << endl;
+
+    if (!imageExiste) {
+        //les recherches un-vers-tous profitent de la localité station-temps des numéros de sommets
+        debutGraphe = chrono::steady_clock::now();
+        reseau_rtc.renumeroterSommets(donnees_rtc);
+        finGraphe = chrono::steady_clock::now();
+        cout << "Sommets renumérotés en " << chrono::duration<double>(finGraphe - debutGraphe).count() << " secondes"
+             << endl;
+
+        if (!nomFichierImage.empty()) {
+            reseau_rtc.sauvegarderImage(donnees_rtc, nomFichierImage);
+            cout << "Image du graphe sauvegardée dans " << nomFichierImage << endl;
+        }
+    }
+
+    vector<PosteMemoire> bilan;
+    donnees_rtc.bilanMemoire(bilan);
+    cout << endl << "Mémoire des données GTFS:" << endl;
+    afficherBilanMemoire(cout, bilan);
+    reseau_rtc.bilanMemoire(bilan);
+    cout << "Mémoire du réseau:" << endl;
+    afficherBilanMemoire(cout, bilan);
+    cout << endl;
+
+    ofstream sortie(nomFichierSortie);
+    if (!sortie.is_open()) throw logic_error("main(): impossible d'ouvrir le fichier de sortie " + nomFichierSortie);
+
+    auto debut = chrono::steady_clock::now();
+    reseau_rtc.matriceTempsDeParcours(donnees_rtc, now1, nbThreads, sortie);
+    auto fin = chrono::steady_clock::now();
+    cout << "Matrice " << donnees_rtc.getNbStations() << " x " << donnees_rtc.getNbStations() << " écrite dans "
+         << nomFichierSortie << " en " << chrono::duration<double>(fin - debut).count() << " secondes" << endl;
+
+    if (!nomFichierTrace.empty()) {
+        Trace::ecrireFichier(nomFichierTrace);
+        cout << "Trace écrite dans " << nomFichierTrace << endl;
+    }
+
+    return 0;
+}
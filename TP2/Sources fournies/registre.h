@@ -0,0 +1,64 @@
+//
+// Registre d'objets par thread (tampons de trace, histogrammes de latences) lisibles de n'importe quel thread
+//
+
+#ifndef RTC_REGISTRE_H
+#define RTC_REGISTRE_H
+
+#include <mutex>
+#include <memory>
+#include <vector>
+
+/*!
+ * \class RegistreParThread
+ * \brief Donne à chaque thread son propre objet T, créé (par le constructeur par défaut, dans ce thread) à son premier
+ * \brief appel de duThread(); les appels suivants ne coûtent qu'une lecture d'un pointeur thread_local.
+ * \brief pourChacun() parcourt les objets de tous les threads, y compris ceux des threads terminés: les objets ne sont
+ * \brief jamais détruits, pas plus que le registre, car des threads peuvent encore y écrire pendant la destruction des
+ * \brief objets statiques.
+ * \brief Il y a un registre par type T; T protège lui-même ses données si pourChacun() les lit pendant que leur
+ * \brief thread les modifie.
+ */
+template<typename T>
+class RegistreParThread
+{
+public:
+    //! \brief retourne l'objet du thread courant, créé et ajouté au registre au premier appel
+    static T &duThread()
+    {
+        static thread_local T *t_objet = nullptr;
+        if (t_objet == nullptr)
+        {
+            std::unique_ptr<T> objet(new T);
+            t_objet = objet.get();
+            std::lock_guard<std::mutex> verrou(registre().m_mutex);
+            registre().m_objets.push_back(std::move(objet));
+        }
+        return *t_objet;
+    }
+
+    //! \brief appelle p_fonction(numero, objet) pour l'objet de chaque thread, numérotés dans l'ordre de leur création
+    //! \note le registre est verrouillé pendant le parcours: p_fonction ne doit appeler ni pourChacun(), ni duThread()
+    //! \note pour la première fois dans son thread
+    template<typename Fonction>
+    static void pourChacun(Fonction p_fonction)
+    {
+        std::lock_guard<std::mutex> verrou(registre().m_mutex);
+        for (size_t k = 0; k < registre().m_objets.size(); ++k) p_fonction(k, *registre().m_objets[k]);
+    }
+
+private:
+    struct Registre
+    {
+        std::mutex m_mutex;
+        std::vector<std::unique_ptr<T> > m_objets;
+    };
+
+    static Registre &registre()
+    {
+        static Registre *leRegistre = new Registre;
+        return *leRegistre;
+    }
+};
+
+#endif //RTC_REGISTRE_H
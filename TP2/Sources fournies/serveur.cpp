@@ -0,0 +1,335 @@
+//
+// Serveur de requêtes d'itinéraires: charge le réseau une seule fois puis répond aux requêtes d'un flux de lignes
+//
+
+#include <iostream>
+#include <sstream>
+#include <string>
+#include <vector>
+#include <map>
+#include <deque>
+#include <thread>
+#include <mutex>
+#include <condition_variable>
+#include <chrono>
+#include <cstdlib>
+#include <csignal>
+#include <cstring>
+#include <unistd.h>
+#include <sys/socket.h>
+#include <sys/un.h>
+
+#include "DonneesGTFS.h"
+#include "ReseauGTFS.h"
+#include "ReseauPublie.h"
+#include "Mesures.h"
+#include "FileBornee.h"
+#include "RequeteOD.h"
+
+using namespace std;
+
+//! \brief écrit tout p_texte dans le descripteur p_fd
+//! \return false si l'écriture a échoué (par exemple si le client s'est déconnecté)
+bool ecrireTout(int p_fd, const string &p_texte)
+{
+    size_t ecrit = 0;
+    while (ecrit < p_texte.size())
+    {
+        ssize_t n = write(p_fd, p_texte.data() + ecrit, p_texte.size() - ecrit);
+        if (n <= 0) return false;
+        ecrit += (size_t) n;
+    }
+    return true;
+}
+
+//! \brief un flux de requêtes (l'entrée standard ou une connexion): les réponses, calculées en parallèle, sont écrites
+//! \brief dans l'ordre des requêtes, ce qui permet au client d'envoyer plusieurs requêtes sans attendre les réponses
+class Connexion
+{
+public:
+    explicit Connexion(int p_fdSortie) : m_fdSortie(p_fdSortie), m_nbSoumises(0), m_prochaineAEcrire(0) {}
+
+    size_t soumettre()
+    {
+        lock_guard<mutex> verrou(m_mutex);
+        return m_nbSoumises++;
+    }
+
+    void repondre(size_t p_numero, const string &p_reponse)
+    {
+        lock_guard<mutex> verrou(m_mutex);
+        m_enAttente[p_numero] = p_reponse;
+        while (!m_enAttente.empty() and m_enAttente.begin()->first == m_prochaineAEcrire)
+        {
+            ecrireTout(m_fdSortie, m_enAttente.begin()->second + "\n");
+            m_enAttente.erase(m_enAttente.begin());
+            ++m_prochaineAEcrire;
+        }
+        if (m_prochaineAEcrire == m_nbSoumises) m_toutEcrit.notify_all();
+    }
+
+    void attendreReponses()
+    {
+        unique_lock<mutex> verrou(m_mutex);
+        m_toutEcrit.wait(verrou, [this]() { return m_prochaineAEcrire == m_nbSoumises; });
+    }
+
+private:
+    int m_fdSortie;
+    size_t m_nbSoumises;
+    size_t m_prochaineAEcrire;
+    map<size_t, string> m_enAttente; //réponses calculées mais pas encore écrites (hors ordre)
+    mutex m_mutex;
+    condition_variable m_toutEcrit;
+};
+
+struct Tache
+{
+    shared_ptr<Connexion> connexion;
+    size_t numero;
+    string requete;
+};
+
+//! \brief paramètres du serveur
+struct Configuration
+{
+    string dossier;
+    Date date;
+    Heure debut;
+    Heure fin;
+};
+
+//! \brief répond à une requête "lat_origine,lon_origine,lat_destination,lon_destination,AAAA-MM-JJ,HH:MM:SS[,DETAIL]"
+//! \return "OK,départ,arrivée,durée en secondes", "AUCUN" si la destination est inatteignable ou "ERREUR,message"
+//! \return avec DETAIL, "OK," suivi de l'itinéraire en JSON sur une ligne (voir Itineraire::ecrireJson())
+string repondre(const string &p_requete, const Configuration &p_config, const DonneesGTFS &p_donnees,
+                ReseauGTFS &p_reseau)
+{
+    try
+    {
+        vector<string> champs = separerChamps(p_requete);
+        if (champs.size() != 6 and !(champs.size() == 7 and champs[6] == "DETAIL"))
+            throw logic_error("6 champs attendus, plus DETAIL au besoin");
+        const bool detail = champs.size() == 7;
+        RequeteOD requete = lireRequeteOD(champs);
+        verifierRequeteOD(requete, p_config.date, p_config.debut, p_config.fin);
+        const Heure &depart = requete.depart;
+
+        unsigned int duree;
+        Itineraire itineraire;
+        if (detail)
+        {
+            itineraire = itineraireRequeteOD(p_donnees, p_reseau, requete);
+            duree = itineraire.statut == Itineraire::Inatteignable ? numeric_limits<unsigned int>::max()
+                                                                    : itineraire.duree;
+        }
+        else
+            duree = dureeRequeteOD(p_donnees, p_reseau, requete);
+
+        if (duree == numeric_limits<unsigned int>::max()) return "AUCUN";
+        ostringstream reponse;
+        if (detail)
+        {
+            MesuresItineraire::Chronometre chronometre(MesuresItineraire::Rendu);
+            reponse << "OK,";
+            itineraire.ecrireJson(p_donnees, reponse);
+            return reponse.str();
+        }
+        reponse << "OK," << depart << "," << depart.add_secondes(duree) << "," << duree;
+        return reponse.str();
+    }
+    catch (const exception &e)
+    {
+        return string("ERREUR,") + e.what();
+    }
+}
+
+//! \brief travailleur: chacun a sa copie du réseau de l'instantané courant, car une requête y ajoute temporairement
+//! \brief les points origine et destination. La copie est faite à la première tâche qui suit une publication; un
+//! \brief travailleur inactif relâche dans la seconde la copie et l'instantané remplacés, pour que ce dernier soit détruit.
+void travailleur(FileBornee<Tache> &p_file, PublicationReseau &p_publication, const Configuration &p_config)
+{
+    unsigned long version = 0;
+    PublicationReseau::Ptr instantane;
+    unique_ptr<ReseauGTFS> reseau;
+
+    Tache tache;
+    for (;;)
+    {
+        FileBornee<Tache>::Resultat resultat = p_file.retirer(tache, chrono::milliseconds(500));
+        if (resultat == FileBornee<Tache>::Fermee) break;
+        if (instantane and p_publication.getVersion() != version)
+        {
+            reseau.reset();
+            instantane.reset();
+        }
+        if (resultat == FileBornee<Tache>::Vide) continue;
+
+        if (!instantane)
+        {
+            version = p_publication.getVersion(); //lue avant obtenir(): au pire, la copie sera refaite inutilement
+            instantane = p_publication.obtenir();
+            reseau.reset(new ReseauGTFS(instantane->reseau));
+        }
+        tache.connexion->repondre(tache.numero, repondre(tache.requete, p_config, instantane->donnees, *reseau));
+        tache = Tache();
+    }
+}
+
+//! \brief publie un nouvel instantané chargé du dossier de la configuration, en arrière-plan
+//! \brief Un échec est écrit sur cerr dès qu'il survient, et rapporté en réponse au RECHARGER suivant; l'instantané
+//! \brief courant reste alors publié.
+class Rechargement
+{
+public:
+    Rechargement(PublicationReseau &p_publication, const Configuration &p_config)
+            : m_publication(p_publication), m_config(p_config) {}
+
+    //! \return la réponse à la ligne RECHARGER: "OK,RECHARGEMENT" si un rechargement est lancé, une erreur si un
+    //! \return rechargement est en cours ou si le précédent a échoué (le RECHARGER suivant en relance alors un)
+    string lancer(unsigned int p_nbThreads)
+    {
+        lock_guard<mutex> verrou(m_mutex);
+        if (m_enCours.valid())
+        {
+            if (m_enCours.wait_for(chrono::seconds(0)) != future_status::ready) return "ERREUR,rechargement en cours";
+            try
+            {
+                m_enCours.get(); //relance l'exception de la construction, le cas échéant
+            }
+            catch (const exception &e)
+            {
+                return string("ERREUR,le rechargement précédent a échoué: ") + e.what();
+            }
+        }
+        const Configuration config = m_config;
+        m_enCours = m_publication.publierEnArrierePlan([config, p_nbThreads]() {
+            try
+            {
+                return PublicationReseau::Ptr(
+                        new InstantaneReseau(config.dossier, config.date, config.debut, config.fin, p_nbThreads));
+            }
+            catch (const exception &e)
+            {
+                cerr << "Rechargement échoué: " << e.what() << endl;
+                throw;
+            }
+        });
+        return "OK,RECHARGEMENT";
+    }
+
+private:
+    PublicationReseau &m_publication;
+    const Configuration &m_config;
+    mutex m_mutex;
+    future<void> m_enCours;
+};
+
+//! \brief lit les requêtes de p_fdEntree, une par ligne, et les soumet aux travailleurs; les réponses vont dans p_fdSortie
+//! \brief la ligne "RECHARGER" recharge les données GTFS en arrière-plan sans interrompre les requêtes
+//! \brief la ligne "MESURES" répond "OK," suivi des histogrammes de latence par phase et par travailleur (JSON sur une
+//! \brief ligne, en nanosecondes), tels qu'au moment où la ligne est lue
+void traiterFlux(int p_fdEntree, int p_fdSortie, FileBornee<Tache> &p_file, Rechargement &p_rechargement)
+{
+    shared_ptr<Connexion> connexion = make_shared<Connexion>(p_fdSortie);
+    string tampon;
+    char morceau[4096];
+    for (;;)
+    {
+        ssize_t n = read(p_fdEntree, morceau, sizeof(morceau));
+        if (n <= 0) break;
+        tampon.append(morceau, (size_t) n);
+
+        size_t debut = 0;
+        for (size_t fin = tampon.find('\n'); fin != string::npos; fin = tampon.find('\n', debut))
+        {
+            string ligne = tampon.substr(debut, fin - debut);
+            debut = fin + 1;
+            if (!ligne.empty() and ligne.back() == '\r') ligne.pop_back();
+            if (ligne.empty()) continue;
+
+            size_t numero = connexion->soumettre();
+            if (ligne == "RECHARGER")
+                connexion->repondre(numero, p_rechargement.lancer(0));
+            else if (ligne == "MESURES")
+            {
+                ostringstream mesures;
+                MesuresItineraire::ecrireJson(mesures, true);
+                connexion->repondre(numero, "OK," + mesures.str());
+            }
+            else
+                p_file.ajouter(Tache{connexion, numero, ligne});
+        }
+        tampon.erase(0, debut);
+    }
+    connexion->attendreReponses();
+}
+
+//! \brief usage: serveur [nb_travailleurs] [chemin_socket] [AAAA-MM-JJ] [HH:MM:SS debut] [HH:MM:SS fin]
+//! \brief nb_travailleurs = 0 (par défaut) utilise tous les coeurs disponibles
+//! \brief sans chemin_socket (ou avec -), les requêtes sont lues de l'entrée standard et les réponses écrites sur la
+//! \brief sortie standard; sinon le serveur écoute sur ce socket Unix et sert chaque connexion de la même façon
+//! \brief Le réseau est chargé pour la date et l'intervalle donnés (2017-08-18, 00:00:00 à 30:00:00 par défaut, comme
+//! \brief lot); une requête d'une autre date, ou dont l'heure est hors de l'intervalle, reçoit une erreur.
+//! \brief requête: lat_origine,lon_origine,lat_destination,lon_destination,AAAA-MM-JJ,HH:MM:SS[,DETAIL]
+int main(int argc, char *argv[])
+{
+    Configuration config;
+    config.dossier = "RTC-8aout-1dec";
+    config.date = argc > 3 ? lireDate(argv[3]) : Date(2017, 8, 18);
+    config.debut = argc > 4 ? lireHeure(argv[4]) : Heure(0, 0, 0);
+    config.fin = argc > 5 ? lireHeure(argv[5]) : Heure(30, 0, 0); //un voyage débuté avant minuit peut finir après
+
+    unsigned int nbTravailleurs = argc > 1 ? (unsigned int) atoi(argv[1]) : 0;
+    if (nbTravailleurs == 0) nbTravailleurs = max(1u, thread::hardware_concurrency());
+    string cheminSocket = argc > 2 ? argv[2] : "-";
+
+    signal(SIGPIPE, SIG_IGN); //un client déconnecté ne doit pas arrêter le serveur
+
+    auto debut = chrono::steady_clock::now();
+    PublicationReseau publication;
+    publication.publier(PublicationReseau::Ptr(
+            new InstantaneReseau(config.dossier, config.date, config.debut, config.fin, 0)));
+    auto fin = chrono::steady_clock::now();
+    cerr << "Réseau chargé en " << chrono::duration<double>(fin - debut).count() << " secondes; "
+         << nbTravailleurs << " travailleurs" << endl;
+
+    FileBornee<Tache> file(4 * nbTravailleurs);
+    vector<thread> travailleurs;
+    for (unsigned int t = 0; t < nbTravailleurs; ++t)
+        travailleurs.push_back(thread(travailleur, ref(file), ref(publication), cref(config)));
+    Rechargement rechargement(publication, config);
+
+    if (cheminSocket.empty() or cheminSocket == "-")
+    {
+        traiterFlux(STDIN_FILENO, STDOUT_FILENO, file, rechargement);
+    }
+    else
+    {
+        int serveur = socket(AF_UNIX, SOCK_STREAM, 0);
+        sockaddr_un adresse;
+        memset(&adresse, 0, sizeof(adresse));
+        adresse.sun_family = AF_UNIX;
+        if (serveur < 0 or cheminSocket.size() >= sizeof(adresse.sun_path))
+            throw logic_error("main(): impossible de créer le socket " + cheminSocket);
+        strcpy(adresse.sun_path, cheminSocket.c_str());
+        unlink(cheminSocket.c_str());
+        if (bind(serveur, (sockaddr *) &adresse, sizeof(adresse)) != 0 or listen(serveur, 16) != 0)
+            throw logic_error("main(): impossible d'écouter sur le socket " + cheminSocket);
+        cerr << "En écoute sur " << cheminSocket << endl;
+
+        for (;;)
+        {
+            int client = accept(serveur, nullptr, nullptr);
+            if (client < 0) continue;
+            thread([client, &file, &rechargement]() {
+                traiterFlux(client, client, file, rechargement);
+                close(client);
+            }).detach();
+        }
+    }
+
+    file.fermer();
+    for (auto &t : travailleurs) t.join();
+    return 0;
+}
@@ -0,0 +1,114 @@
+//
+// Histogrammes de latences (HDR) et mesures par phase des recherches d'itinéraires
+//
+
+#ifndef TP2_MESURES_H
+#define TP2_MESURES_H
+
+#include <vector>
+#include <ostream>
+#include <chrono>
+#include <thread>
+#include <cstdint>
+#include <atomic>
+
+//! \brief histogramme à plage dynamique élevée (HDR) de valeurs entières (ex.: des nanosecondes)
+//! \brief Les compteurs sont log-linéaires: chaque puissance de 2 est découpée en 128 sous-intervalles égaux, ce qui
+//! \brief garantit une erreur relative d'au plus 1/128 (< 1%) sur toute valeur lue, de 1 à 2^36 (plus de 68 s en ns).
+//! \brief Les valeurs plus grandes sont comptées dans le dernier sous-intervalle (getMax() reste exact).
+//! \brief Deux histogrammes se fusionnent sans perte: la fusion des histogrammes de chaque thread donne celui de tous.
+class HistogrammeHDR
+{
+public:
+    static const unsigned int BITS_SOUS_INTERVALLES = 7; //128 sous-intervalles par puissance de 2
+    static const unsigned int BITS_VALEUR_MAX = 36; //les valeurs suivies exactement sont < 2^36
+    static const size_t NB_COMPTEURS = (BITS_VALEUR_MAX - BITS_SOUS_INTERVALLES + 1) << BITS_SOUS_INTERVALLES;
+
+    HistogrammeHDR();
+    void enregistrer(uint64_t, uint64_t = 1);
+    void fusionner(const HistogrammeHDR &);
+    uint64_t getNombre() const;
+    uint64_t getMin() const;
+    uint64_t getMax() const;
+    double getMoyenne() const;
+    uint64_t valeurAuPercentile(double) const;
+    void ecrireJson(std::ostream &) const;
+
+    static size_t indice(uint64_t);
+    static uint64_t valeurMaxDe(size_t);
+
+private:
+    friend class HistogrammeUnEcrivain;
+
+    std::vector<uint64_t> m_compteurs; //m_compteurs[indice(v)] est le nombre de valeurs v enregistrées
+    uint64_t m_nombre; //le nombre de valeurs enregistrées
+    uint64_t m_somme; //la somme des valeurs enregistrées
+    uint64_t m_min; //la plus petite valeur enregistrée (numeric_limits<uint64_t>::max() si aucune)
+    uint64_t m_max; //la plus grande valeur enregistrée (0 si aucune)
+};
+
+//! \brief histogramme HDR qu'un seul thread (l'écrivain) alimente pendant que d'autres le lisent
+//! \brief Les compteurs sont atomiques, mais l'écrivain les incrémente par une lecture suivie d'une écriture plutôt
+//! \brief que par une instruction verrouillée: enregistrer() coûte à peine plus que pour un HistogrammeHDR.
+class HistogrammeUnEcrivain
+{
+public:
+    HistogrammeUnEcrivain();
+    void enregistrer(uint64_t);
+    HistogrammeHDR lire() const;
+    void vider();
+
+private:
+    std::atomic<uint64_t> m_compteurs[HistogrammeHDR::NB_COMPTEURS];
+    std::atomic<uint64_t> m_nombre;
+    std::atomic<uint64_t> m_somme;
+    std::atomic<uint64_t> m_min;
+    std::atomic<uint64_t> m_max;
+};
+
+//! \brief mesures toujours actives des phases des recherches d'itinéraires, un jeu d'histogrammes par thread
+//! \brief Chaque thread enregistre dans ses propres histogrammes (HistogrammeUnEcrivain), sans verrou; les lectures
+//! \brief (parThread(), fusion(), ecrireJson()) peuvent se faire pendant que les threads enregistrent et donnent un
+//! \brief état récent, pas un instantané exact.
+//! \brief Les compteurs d'un thread terminé sont conservés: ses mesures restent dans les lectures suivantes.
+class MesuresItineraire
+{
+public:
+    //! \brief les phases mesurées, en nanosecondes
+    enum Phase
+    {
+        AjoutArcs, //ajouterArcsOrigineDestinations(): points origine et destination et leurs arcs de marche
+        Recherche, //le plus court chemin (incluant la remontée des prédécesseurs)
+        Reconstruction, //la vérification du chemin et la mise en forme de l'itinéraire
+        Rendu, //l'écriture de l'itinéraire mis en forme
+        NbPhases
+    };
+
+    //! \brief mesure le temps écoulé entre sa construction et sa destruction dans une phase
+    class Chronometre
+    {
+    public:
+        explicit Chronometre(Phase p_phase) : m_phase(p_phase), m_debut(std::chrono::steady_clock::now()) {}
+        ~Chronometre()
+        {
+            enregistrer(m_phase, (uint64_t) std::chrono::duration_cast<std::chrono::nanoseconds>(
+                    std::chrono::steady_clock::now() - m_debut).count());
+        }
+        Chronometre(const Chronometre &) = delete;
+        Chronometre &operator=(const Chronometre &) = delete;
+
+    private:
+        Phase m_phase;
+        std::chrono::steady_clock::time_point m_debut;
+    };
+
+    static void enregistrer(Phase, uint64_t);
+    static std::vector<HistogrammeHDR> parThread(Phase, std::vector<std::thread::id> &);
+    static HistogrammeHDR fusion(Phase);
+    static void ecrireJson(std::ostream &, bool = false);
+    static void reinitialiser();
+    static const char *nomPhase(Phase);
+};
+
+
+#endif //TP2_MESURES_H
@@ -0,0 +1,80 @@
+//
+// Publication d'instantanés (données GTFS + réseau) remplaçables sans interrompre les requêtes
+//
+
+#ifndef TP2_RESEAUPUBLIE_H
+#define TP2_RESEAUPUBLIE_H
+
+#include <memory>
+#include <mutex>
+#include <atomic>
+#include <future>
+#include <functional>
+#include <thread>
+#include <condition_variable>
+#include <vector>
+
+#include "DonneesGTFS.h"
+#include "ReseauGTFS.h"
+
+DonneesGTFS chargerDonneesGTFS(const std::string &, const Date &, const Heure &, const Heure &);
+
+//! \brief une version complète des horaires: les données GTFS et le réseau construit à partir de celles-ci
+//! \brief Une fois publié, un instantané n'est plus modifié; seules les méthodes const du réseau (profil,
+//! \brief isochrone, matriceTempsDeParcours) peuvent donc y être appelées, par plusieurs threads à la fois.
+//! \brief Une requête d'itinéraire (itineraireRequeteOD(), dureeRequeteOD()) modifie le réseau: elle y ajoute puis en
+//! \brief enlève les points origine et destination. Elle se fait donc sur une copie du réseau, graphe compris: chaque
+//! \brief thread de lot en fait une, et chaque travailleur du serveur refait la sienne à sa première requête qui suit
+//! \brief une publication (voir travailleur() dans serveur.cpp).
+struct InstantaneReseau
+{
+    InstantaneReseau(const std::string &p_dossier, const Date &p_date, const Heure &p_debut, const Heure &p_fin,
+                     unsigned int p_nbThreads = 0);
+
+    DonneesGTFS donnees;
+    ReseauGTFS reseau; //construit à partir de donnees (les arrets de donnees connaissent leur sommet dans reseau)
+};
+
+//! \brief point de publication de l'instantané courant, à la manière de RCU
+//! \brief Une requête obtient l'instantané courant (un shared_ptr) et le garde jusqu'à la fin de son traitement; la
+//! \brief publication d'un nouvel instantané remplace atomiquement le pointeur, sans attendre les requêtes en cours.
+//! \brief Dès que la dernière requête qui détenait un instantané remplacé le relâche, celui-ci est confié à un thread
+//! \brief de destruction propre à la publication: la destruction ne pèse jamais sur une requête.
+//! \pre les pointeurs obtenus sont tous relâchés avant la destruction de la publication
+class PublicationReseau
+{
+public:
+    typedef std::shared_ptr<const InstantaneReseau> Ptr;
+
+    PublicationReseau();
+    ~PublicationReseau();
+    Ptr obtenir() const;
+    unsigned long getVersion() const;
+    void publier(const Ptr &p_instantane);
+    std::future<void> publierEnArrierePlan(const std::function<Ptr()> &p_construction);
+    size_t getNbRetires() const;
+
+private:
+    //! \brief déléteur des pointeurs publiés: confie l'instantané au thread de destruction au départ du dernier lecteur
+    struct Liberation
+    {
+        PublicationReseau *publication;
+        Ptr instantane;
+
+        void operator()(const InstantaneReseau *);
+    };
+
+    Ptr m_courant; //lu et remplacé uniquement par std::atomic_load() et std::atomic_exchange()
+    std::atomic<unsigned long> m_version; //nombre d'instantanés publiés
+    mutable std::mutex m_mutexRetires; //sérialise les publications et protège les membres qui suivent
+    size_t m_nbRetires; //instantanés remplacés qui n'ont pas encore été détruits
+    std::vector<Ptr> m_aDetruire; //instantanés remplacés que plus aucune requête ne détient
+    bool m_arret; //vrai lorsque le thread de destruction doit terminer, une fois m_aDetruire vidé
+    std::condition_variable m_aDetruireNonVide;
+    std::thread m_destructeur; //déclaré en dernier: démarre une fois les autres membres construits
+
+    void detruireRetires();
+};
+
+
+#endif //TP2_RESEAUPUBLIE_H
@@ -33,6 +33,10 @@ public:
 	unsigned int getNumeroSequence() const;
 	unsigned int getStationId() const;
 	std::string getVoyageId() const;
+	size_t getSommet() const;
+	void setSommet(size_t p_sommet);
+	int getRetard() const;
+	void appliquerRetard(int p_retard);
 
 	bool operator< (const Arret & p_other) const;
 	bool operator> (const Arret & p_other) const;
@@ -45,6 +49,8 @@ private:
 	Heure m_heure_depart;
 	unsigned int m_numero_sequence;
 	std::string m_voyage_id;
+	size_t m_sommet; //numéro dense de l'arret (sommet du graphe espace-temps qui le représente)
+	int m_retard; //le retard, en secondes, inclus dans m_heure_arrivee et m_heure_depart par rapport à l'horaire prévu
 };
 
 
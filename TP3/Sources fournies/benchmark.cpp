@@ -0,0 +1,253 @@
+//
+// Banc d'essai reproductible des recherches d'itinéraires: latences (percentiles) et effort par catégorie de requêtes
+//
+
+#include <iostream>
+#include <fstream>
+#include <sstream>
+#include <random>
+#include <chrono>
+#include <algorithm>
+#include <limits>
+#include <cstdlib>
+
+#include "DonneesGTFS.h"
+#include "ReseauGTFS.h"
+#include "Mesures.h"
+#include "ReseauPublie.h"
+#include "Echantillonnage.h"
+
+using namespace std;
+
+//! \brief une catégorie de requêtes: paires de stations dont la distance est dans [distanceMin, distanceMax) km
+struct Categorie
+{
+    string nom;
+    double distanceMin;
+    double distanceMax;
+    unsigned int departMin; //intervalle des heures de départ, en secondes après minuit
+    unsigned int departMax;
+    bool inatteignable; //ne garder que les requêtes sans itinéraire, vérifiées par une recherche avant les mesures
+};
+
+//! \brief une requête de la catégorie, tirée avant les mesures
+struct Requete
+{
+    const Station *origine;
+    const Station *destination;
+    Heure depart;
+};
+
+//! \brief une requête tirée au hasard et ses mesures
+struct Mesure
+{
+    double latenceRecherche; //microsecondes, la recherche seulement
+    double latenceTotale; //microsecondes, ajout des points origine et destination, recherche et retrait
+    ReseauGTFS::StatistiquesRecherche statistiques;
+    bool atteinte;
+    bool erreur; //aucun arrêt à distance de marche: latenceTotale est le temps écoulé jusqu'à l'exception
+};
+
+//! \brief écrit l'objet JSON {"p50", "p90", "p99", "max", "moyenne"} des valeurs
+void ecrireDistribution(ostream &p_sortie, vector<double> p_valeurs)
+{
+    sort(p_valeurs.begin(), p_valeurs.end());
+    double somme = 0;
+    for (double v : p_valeurs) somme += v;
+    p_sortie << "{\"p50\": " << percentile(p_valeurs, 50) << ", \"p90\": " << percentile(p_valeurs, 90)
+             << ", \"p99\": " << percentile(p_valeurs, 99) << ", \"max\": " << (p_valeurs.empty() ? 0 : p_valeurs.back())
+             << ", \"moyenne\": " << (p_valeurs.empty() ? 0 : somme / p_valeurs.size()) << "}";
+}
+
+//! \brief tire au hasard une paire de stations de la catégorie et une heure de départ
+//! \return false si aucune paire n'a été trouvée (la catégorie ne s'applique pas à ce réseau)
+bool tirerRequete(const Categorie &p_categorie, const vector<const Station *> &p_stations, mt19937 &p_generateur,
+                  Requete &p_requete)
+{
+    if (!tirerPaireDeStations(p_stations, p_categorie.distanceMin, p_categorie.distanceMax, p_generateur,
+                              p_requete.origine, p_requete.destination))
+        return false;
+    p_requete.depart = tirerHeure(p_categorie.departMin, p_categorie.departMax, p_generateur);
+    return true;
+}
+
+//! \brief exécute une requête et la mesure, y compris lorsque ajouterArcsOrigineDestination() la rejette
+Mesure mesurer(const DonneesGTFS &p_donnees, ReseauGTFS &p_reseau, const Requete &p_requete)
+{
+    Mesure mesure;
+    mesure.latenceRecherche = 0;
+    mesure.atteinte = false;
+    mesure.erreur = false;
+    auto debut = chrono::steady_clock::now();
+    try
+    {
+        p_reseau.ajouterArcsOrigineDestination(p_donnees, p_requete.origine->getCoords(),
+                                               p_requete.destination->getCoords(), p_requete.depart);
+    }
+    catch (const logic_error &)
+    {
+        mesure.latenceTotale = chrono::duration<double, micro>(chrono::steady_clock::now() - debut).count();
+        mesure.erreur = true;
+        return mesure;
+    }
+    auto debutRecherche = chrono::steady_clock::now();
+    unsigned int duree = p_reseau.dureeItineraire(mesure.statistiques);
+    auto finRecherche = chrono::steady_clock::now();
+    p_reseau.enleverArcsOrigineDestination();
+    auto fin = chrono::steady_clock::now();
+
+    mesure.latenceRecherche = chrono::duration<double, micro>(finRecherche - debutRecherche).count();
+    mesure.latenceTotale = chrono::duration<double, micro>(fin - debut).count();
+    mesure.atteinte = duree != numeric_limits<unsigned int>::max();
+    return mesure;
+}
+
+//! \brief usage: benchmark [fichier_json] [germe] [nb_requetes] [nb_rechauffement] [categories]
+//! \brief par défaut: benchmark.json, germe 1, 200 requêtes par catégorie, 20 requêtes de réchauffement et toutes les
+//! \brief catégories; categories est une liste séparée par des virgules (ex.: courte,inatteignable)
+//! \brief Les requêtes ne dépendent que du germe et des données: deux exécutions mesurent les mêmes itinéraires
+int main(int argc, char *argv[])
+{
+    const string chemin_dossier = "RTC-8aout-1dec";
+    const Date today(2017, 8, 18);
+    const Heure now1(0, 0, 0);
+    const Heure now2(30, 0, 0);
+
+    string nomFichierJson = argc > 1 ? argv[1] : "benchmark.json";
+    unsigned int germe = argc > 2 ? (unsigned int) atoi(argv[2]) : 1;
+    unsigned int nbRequetes = argc > 3 ? (unsigned int) atoi(argv[3]) : 200;
+    unsigned int nbRechauffement = argc > 4 ? (unsigned int) atoi(argv[4]) : 20;
+    string categoriesChoisies = argc > 5 ? argv[5] : "";
+
+    DonneesGTFS donnees_rtc = chargerDonneesGTFS(chemin_dossier, today, now1, now2);
+    ReseauGTFS reseau_rtc(donnees_rtc);
+
+    //la fin du service: la dernière arrivée à une station
+    unsigned int finService = 0;
+    for (const auto &station : donnees_rtc.getStations())
+        finService = max(finService, (unsigned int) (station.second.getArrets().rbegin()->first - now1));
+
+    const double dMarche = reseau_rtc.getDistMaxMarche();
+    const unsigned int h = 3600;
+    //"tardive": départs peu avant la fin du service, où la recherche épuise souvent ce qui reste du réseau sans
+    //atteindre la destination (nb_atteintes indique combien l'ont été)
+    //"inatteignable": les mêmes départs, mais seulement les requêtes sans itinéraire, vérifiées avant les mesures
+    const double infini = numeric_limits<double>::max();
+    vector<Categorie> categories = {
+            {"courte",        2.1 * dMarche, 5.0,    7 * h,              19 * h,           false},
+            {"moyenne",       5.0,           10.0,   7 * h,              19 * h,           false},
+            {"traversee",     10.0,          infini, 7 * h,              19 * h,           false},
+            {"tardive",       2.1 * dMarche, infini, finService - 1800, finService - 600, false},
+            {"inatteignable", 2.1 * dMarche, infini, finService - 1800, finService - 600, true}};
+    if (!categoriesChoisies.empty())
+    {
+        vector<Categorie> choisies;
+        stringstream flux(categoriesChoisies);
+        string nom;
+        while (getline(flux, nom, ','))
+        {
+            auto categorie = find_if(categories.begin(), categories.end(),
+                                     [&nom](const Categorie &c) { return c.nom == nom; });
+            if (categorie == categories.end()) throw logic_error("main(): catégorie inconnue " + nom);
+            choisies.push_back(*categorie);
+        }
+        categories.swap(choisies);
+    }
+
+    vector<const Station *> stations;
+    for (const auto &station : donnees_rtc.getStations()) stations.push_back(&station.second);
+
+    //chaque catégorie a son propre générateur: ajouter ou retirer une catégorie ne change pas les requêtes des autres
+    //Les requêtes sont tirées avant les mesures, car celles d'une catégorie inatteignable passent d'abord par une
+    //recherche qui écarte celles ayant un itinéraire (au plus 50 tirages par requête demandée)
+    vector<vector<Requete> > requetes(categories.size());
+    for (size_t c = 0; c < categories.size(); ++c)
+    {
+        mt19937 generateur(germe * 1000003u + (unsigned int) c);
+        Requete requete;
+        for (unsigned int tirage = 0; requetes[c].size() < nbRequetes && tirage < 50 * nbRequetes; ++tirage)
+        {
+            if (!tirerRequete(categories[c], stations, generateur, requete)) break;
+            if (categories[c].inatteignable && mesurer(donnees_rtc, reseau_rtc, requete).atteinte) continue;
+            requetes[c].push_back(requete);
+        }
+    }
+
+    {
+        mt19937 generateur(germe);
+        Requete requete;
+        for (unsigned int i = 0; i < nbRechauffement; ++i)
+        {
+            const Categorie &categorie = categories[i % categories.size()];
+            if (tirerRequete(categorie, stations, generateur, requete)) mesurer(donnees_rtc, reseau_rtc, requete);
+        }
+    }
+
+    MesuresItineraire::reinitialiser(); //le réchauffement n'est pas mesuré
+
+    ofstream json(nomFichierJson);
+    if (!json.is_open()) throw logic_error("main(): impossible d'ouvrir " + nomFichierJson);
+    json << "{\n  \"germe\": " << germe << ",\n  \"nb_requetes\": " << nbRequetes << ",\n  \"nb_rechauffement\": "
+         << nbRechauffement << ",\n  \"nb_stations\": " << donnees_rtc.getNbStations() << ",\n  \"nb_arrets\": "
+         << donnees_rtc.getNbArrets() << ",\n  \"nb_arcs\": " << reseau_rtc.getNbArcs() << ",\n  \"categories\": [";
+
+    for (size_t c = 0; c < categories.size(); ++c)
+    {
+        const Categorie &categorie = categories[c];
+        vector<Mesure> mesures;
+        vector<double> latencesErreurs; //requêtes rejetées: aucun arrêt (ou départ) à distance de marche
+        for (const Requete &requete : requetes[c])
+        {
+            Mesure mesure = mesurer(donnees_rtc, reseau_rtc, requete);
+            if (mesure.erreur) latencesErreurs.push_back(mesure.latenceTotale);
+            else mesures.push_back(mesure);
+        }
+
+        vector<double> latences, latencesTotales, solutionnes, relachements, empilements, perimees, tailleFile, octets;
+        unsigned int nbAtteintes = 0;
+        for (const Mesure &mesure : mesures)
+        {
+            latences.push_back(mesure.latenceRecherche);
+            latencesTotales.push_back(mesure.latenceTotale);
+            solutionnes.push_back(mesure.statistiques.sommetsSolutionnes);
+            relachements.push_back(mesure.statistiques.relachements);
+            empilements.push_back(mesure.statistiques.empilements);
+            perimees.push_back(mesure.statistiques.entreesPerimees);
+            tailleFile.push_back(mesure.statistiques.tailleMaxFile);
+            octets.push_back(mesure.statistiques.octetsTravail);
+            if (mesure.atteinte) ++nbAtteintes;
+        }
+
+        json << (c ? "," : "") << "\n    {\"nom\": \"" << categorie.nom << "\", \"nb_mesurees\": " << mesures.size()
+             << ", \"nb_atteintes\": " << nbAtteintes << ", \"nb_erreurs\": " << latencesErreurs.size()
+             << ",\n     \"latence_recherche_us\": ";
+        ecrireDistribution(json, latences);
+        json << ",\n     \"latence_erreurs_us\": ";
+        ecrireDistribution(json, latencesErreurs);
+        json << ",\n     \"latence_totale_us\": ";
+        ecrireDistribution(json, latencesTotales);
+        json << ",\n     \"sommets_solutionnes\": ";
+        ecrireDistribution(json, solutionnes);
+        json << ",\n     \"relachements\": ";
+        ecrireDistribution(json, relachements);
+        json << ",\n     \"empilements\": ";
+        ecrireDistribution(json, empilements);
+        json << ",\n     \"entrees_perimees\": ";
+        ecrireDistribution(json, perimees);
+        json << ",\n     \"taille_max_file\": ";
+        ecrireDistribution(json, tailleFile);
+        json << ",\n     \"octets_travail\": ";
+        ecrireDistribution(json, octets);
+        json << "}";
+
+        sort(latences.begin(), latences.end());
+        cout << categorie.nom << ": " << mesures.size() << " requêtes, p50 = " << percentile(latences, 50)
+             << " us, p99 = " << percentile(latences, 99) << " us" << endl;
+    }
+    json << "\n  ],\n  \"phases_ns\": ";
+    MesuresItineraire::ecrireJson(json);
+    json << "\n}\n";
+    cout << "Résultats écrits dans " << nomFichierJson << endl;
+
+    return 0;
+}
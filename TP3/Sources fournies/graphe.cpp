@@ -6,15 +6,50 @@
 //
 
 #include "graphe.h"
+#include <thread>
+#include <cstring>
+#include <cstddef>
+#include <exception>
 
 using namespace std;
 
 //! \brief Constructeur avec paramètre du nombre de sommets désiré
 //! \param[in] p_nbSommets indique le nombre de sommets désiré
 //! \post crée le vecteur de p_nbSommets de listes d'adjacence vides
-Graphe::Graphe(size_t p_nbSommets)
-    : m_listesAdj(p_nbSommets), nbArcs(0)
+template<typename Sommet, typename Poids>
+GrapheGenerique<Sommet, Poids>::GrapheGenerique(size_t p_nbSommets)
+    : m_arene(make_shared<Arene>()), m_listesAdj(p_nbSommets), nbArcs(0), m_nbSommetsImage(0), m_debutArcsImage(nullptr), m_arcsImage(nullptr)
 {
+    if (p_nbSommets > numeric_limits<Sommet>::max())
+        throw logic_error("Graphe::Graphe(): trop de sommets pour le type des numéros de sommets");
+}
+
+//! \brief Constructeur de copie
+//! \post la copie a sa propre arène: ses listes d'adjacence sont sur le tas (voir AllocateurArene) et celles que ses
+//! \post ajouterArcs() remplira ensuite sont dans sa nouvelle arène, jamais dans celle de p_autre
+//! \post le graphe inversé de p_autre est partagé (il est immuable), lu par std::atomic_load(): une recherche concurrente
+//! \post sur p_autre peut le construire pendant la copie
+template<typename Sommet, typename Poids>
+GrapheGenerique<Sommet, Poids>::GrapheGenerique(const GrapheGenerique &p_autre)
+    : m_arene(make_shared<Arene>()), m_listesAdj(p_autre.m_listesAdj), nbArcs(p_autre.nbArcs),
+      m_nbSommetsImage(p_autre.m_nbSommetsImage), m_debutArcsImage(p_autre.m_debutArcsImage),
+      m_arcsImage(p_autre.m_arcsImage), m_inverse(atomic_load(&p_autre.m_inverse))
+{
+}
+
+//! \brief Opérateur d'affectation, avec les mêmes garanties que le constructeur de copie
+template<typename Sommet, typename Poids>
+GrapheGenerique<Sommet, Poids> &GrapheGenerique<Sommet, Poids>::operator=(const GrapheGenerique &p_autre)
+{
+    if (this == &p_autre) return *this;
+    m_arene = make_shared<Arene>();
+    m_listesAdj = vector<ListeArcs>(p_autre.m_listesAdj); //une copie de conteneur est sur le tas
+    nbArcs = p_autre.nbArcs;
+    m_nbSommetsImage = p_autre.m_nbSommetsImage;
+    m_debutArcsImage = p_autre.m_debutArcsImage;
+    m_arcsImage = p_autre.m_arcsImage;
+    atomic_store(&m_inverse, atomic_load(&p_autre.m_inverse));
+    return *this;
 }
 
 //! \brief change le nombre de sommets du graphe
@@ -22,21 +57,55 @@ Graphe::Graphe(size_t p_nbSommets)
 //! \post le graphe est un vecteur de p_nouvelleTaille de listes d'adjacence
 //! \post les anciennes listes d'adjacence sont toujours présentes lorsque p_nouvelleTaille >= à l'ancienne taille
 //! \post les dernières listes d'adjacence sont enlevées lorsque p_nouvelleTaille < à l'ancienne taille
-void Graphe::resize(size_t p_nouvelleTaille)
+template<typename Sommet, typename Poids>
+void GrapheGenerique<Sommet, Poids>::resize(size_t p_nouvelleTaille)
 {
+    if (p_nouvelleTaille > numeric_limits<Sommet>::max())
+        throw logic_error("Graphe::resize(): trop de sommets pour le type des numéros de sommets");
+    if (p_nouvelleTaille < m_nbSommetsImage)
+        throw logic_error("Graphe::resize(): les sommets de l'image sont en lecture seule");
+    invaliderInverse(p_nouvelleTaille); //des sommets couverts par le graphe inversé disparaissent
     m_listesAdj.resize(p_nouvelleTaille);
 }
 
-size_t Graphe::getNbSommets() const
+template<typename Sommet, typename Poids>
+size_t GrapheGenerique<Sommet, Poids>::getNbSommets() const
 {
 	return m_listesAdj.size();
 }
 
-size_t Graphe::getNbArcs() const
+template<typename Sommet, typename Poids>
+size_t GrapheGenerique<Sommet, Poids>::getNbArcs() const
 {
     return nbArcs;
 }
 
+//! \brief retourne les octets alloués pour les listes d'adjacence (selon leur capacité)
+template<typename Sommet, typename Poids>
+size_t GrapheGenerique<Sommet, Poids>::getOctetsListesAdj() const
+{
+    size_t octets = m_listesAdj.capacity() * sizeof(ListeArcs);
+    for (const auto &liste : m_listesAdj) octets += liste.capacity() * sizeof(Arc);
+    return octets;
+}
+
+//! \brief retourne les octets des arcs lus dans l'image attachée (0 sans image): projetés en mémoire, pas alloués
+template<typename Sommet, typename Poids>
+size_t GrapheGenerique<Sommet, Poids>::getOctetsImage() const
+{
+    if (m_nbSommetsImage == 0) return 0;
+    return (m_nbSommetsImage + 1) * sizeof(uint64_t) + m_debutArcsImage[m_nbSommetsImage] * sizeof(Arc);
+}
+
+//! \brief retourne les octets du graphe inversé de plusCourtsCheminsVers() (0 s'il n'est pas construit)
+template<typename Sommet, typename Poids>
+size_t GrapheGenerique<Sommet, Poids>::getOctetsGrapheInverse() const
+{
+    shared_ptr<const GrapheInverse> inverse = atomic_load(&m_inverse);
+    if (!inverse) return 0;
+    return inverse->debut.capacity() * sizeof(size_t) + inverse->arcs.capacity() * sizeof(Arc);
+}
+
 //! \brief ajoute un arc d'un poids donné dans le graphe
 //! \param[in] i: le sommet origine de l'arc
 //! \param[in] j: le sommet destination de l'arc
@@ -44,7 +113,9 @@ size_t Graphe::getNbArcs() const
 //! \pre les sommets i et j doivent exister
 //! \throws logic_error lorsque le sommet i ou le sommet j n'existe pas
 //! \throws logic_error lorsque le poids == numeric_limits<unsigned int>::max()
-void Graphe::ajouterArc(size_t i, size_t j, unsigned int poids)
+//! \throws logic_error lorsque le poids dépasse la capacité du type Poids
+template<typename Sommet, typename Poids>
+void GrapheGenerique<Sommet, Poids>::ajouterArc(size_t i, size_t j, unsigned int poids)
 {
     if (i >= m_listesAdj.size())
         throw logic_error("Graphe::ajouterArc(): tentative d'ajouter l'arc(i,j) avec un sommet i inexistant");
@@ -52,10 +123,161 @@ void Graphe::ajouterArc(size_t i, size_t j, unsigned int poids)
         throw logic_error("Graphe::ajouterArc(): tentative d'ajouter l'arc(i,j) avec un sommet j inexistant");
     if (poids == numeric_limits<unsigned int>::max())
         throw logic_error("Graphe::ajouterArc(): valeur de poids interdite");
+    if (poids > numeric_limits<Poids>::max())
+        throw logic_error("Graphe::ajouterArc(): poids trop grand pour le type des poids");
+    if (i < m_nbSommetsImage)
+        throw logic_error("Graphe::ajouterArc(): les arcs des sommets de l'image sont en lecture seule");
+    invaliderInverse(i);
     m_listesAdj[i].emplace_back(Arc(j, poids));
     ++nbArcs;
 }
 
+//! \brief exécute p_travail(k) pour k = 0..p_nbTaches-1, réparti sur au plus p_nbThreads threads
+//! \brief la première exception lancée par une tâche est relancée une fois tous les threads terminés
+static void executerEnParallele(size_t p_nbTaches, unsigned int p_nbThreads, const function<void(size_t)> &p_travail)
+{
+    const size_t nbThreads = min<size_t>(max(1u, p_nbThreads), p_nbTaches);
+    vector<exception_ptr> erreurs(nbThreads);
+    auto travailleur = [&](size_t t) {
+        try
+        {
+            for (size_t k = t; k < p_nbTaches; k += nbThreads) p_travail(k);
+        }
+        catch (...)
+        {
+            erreurs[t] = current_exception();
+        }
+    };
+
+    vector<thread> threads;
+    for (size_t t = 1; t < nbThreads; ++t) threads.push_back(thread(travailleur, t));
+    if (nbThreads > 0) travailleur(0);
+    for (auto &t : threads) t.join();
+
+    for (auto &e : erreurs)
+        if (e) rethrow_exception(e);
+}
+
+//! \brief ajoute d'un coup les arcs de plusieurs tampons (par exemple produits en parallèle), en parallèle
+//! \brief Les sommets origine sont partagés en p_nbThreads tranches contiguës. Chaque tampon est d'abord compté par tranche,
+//! \brief une somme préfixe donne la position de chaque (tranche, tampon), les arcs sont dispersés à ces positions, puis
+//! \brief chaque liste est réservée à sa taille finale (dans l'arène du graphe) et chaque thread ajoute aux listes
+//! \brief d'adjacence de sa tranche les arcs qui la concernent.
+//! \param[in] p_tampons: les arcs à ajouter
+//! \param[in] p_nbThreads: le nombre de threads à utiliser
+//! \post les listes d'adjacence sont celles qu'aurait données ajouterArc() appelée pour chaque arc, tampon après tampon
+//! \post aucun arc n'est ajouté si une exception est lancée
+//! \throws logic_error lorsqu'un sommet d'un arc n'existe pas ou lorsque son poids == numeric_limits<unsigned int>::max()
+template<typename Sommet, typename Poids>
+void GrapheGenerique<Sommet, Poids>::ajouterArcs(const std::vector<std::vector<ArcAAjouter> > &p_tampons, unsigned int p_nbThreads)
+{
+    const size_t nbSommets = m_listesAdj.size();
+    const size_t nbTranches = max(1u, p_nbThreads);
+    const size_t nbTampons = p_tampons.size();
+    auto tranche = [&](size_t i) { return i * nbTranches / nbSommets; };
+
+    //comptage des arcs de chaque tampon par tranche (compte[b * nbTranches + p])
+    vector<size_t> compte(nbTampons * nbTranches, 0);
+    executerEnParallele(nbTampons, p_nbThreads, [&](size_t b) {
+        for (auto &arc : p_tampons[b])
+        {
+            if (arc.origine >= nbSommets)
+                throw logic_error("Graphe::ajouterArcs(): tentative d'ajouter l'arc(i,j) avec un sommet i inexistant");
+            if (arc.destination >= nbSommets)
+                throw logic_error("Graphe::ajouterArcs(): tentative d'ajouter l'arc(i,j) avec un sommet j inexistant");
+            if (arc.poids == numeric_limits<unsigned int>::max())
+                throw logic_error("Graphe::ajouterArcs(): valeur de poids interdite");
+            if (arc.poids > numeric_limits<Poids>::max())
+                throw logic_error("Graphe::ajouterArcs(): poids trop grand pour le type des poids");
+            if (arc.origine < m_nbSommetsImage)
+                throw logic_error("Graphe::ajouterArcs(): les arcs des sommets de l'image sont en lecture seule");
+            ++compte[b * nbTranches + tranche(arc.origine)];
+        }
+    });
+
+    //somme préfixe dans l'ordre (tranche, tampon): debut[b * nbTranches + p] est la position des arcs de b dans p
+    vector<size_t> debut(nbTampons * nbTranches, 0);
+    vector<size_t> debutTranche(nbTranches + 1, 0);
+    size_t position = 0;
+    for (size_t p = 0; p < nbTranches; ++p)
+    {
+        debutTranche[p] = position;
+        for (size_t b = 0; b < nbTampons; ++b)
+        {
+            debut[b * nbTranches + p] = position;
+            position += compte[b * nbTranches + p];
+        }
+    }
+    debutTranche[nbTranches] = position;
+
+    //dispersion des arcs de chaque tampon à leur position
+    vector<ArcAAjouter> regroupes(position);
+    executerEnParallele(nbTampons, p_nbThreads, [&](size_t b) {
+        for (auto &arc : p_tampons[b]) regroupes[debut[b * nbTranches + tranche(arc.origine)]++] = arc;
+    });
+
+    invaliderInverse();
+
+    //chaque liste qui reçoit des arcs est réservée à sa taille finale: une seule allocation par sommet, dans l'arène
+    //lorsque la liste n'avait encore rien alloué
+    vector<size_t> nbArcsSommet(nbSommets, 0);
+    for (const auto &arc : regroupes) ++nbArcsSommet[arc.origine];
+    for (size_t i = 0; i < nbSommets; ++i)
+    {
+        if (nbArcsSommet[i] == 0) continue;
+        if (m_listesAdj[i].capacity() == 0) m_listesAdj[i] = ListeArcs(AllocateurArene<Arc>(m_arene));
+        m_listesAdj[i].reserve(m_listesAdj[i].size() + nbArcsSommet[i]);
+    }
+
+    //chaque tranche de listes d'adjacence n'est modifiée que par un seul thread
+    executerEnParallele(nbTranches, p_nbThreads, [&](size_t p) {
+        for (size_t k = debutTranche[p]; k < debutTranche[p + 1]; ++k)
+        {
+            m_listesAdj[regroupes[k].origine].emplace_back(Arc(regroupes[k].destination, regroupes[k].poids));
+        }
+    });
+    nbArcs += position;
+}
+
+//! \brief renumérote les sommets du graphe: le sommet i devient le sommet p_nouveauNumero[i]
+//! \brief Les listes d'adjacence sont reconstruites dans l'ordre des nouveaux numéros, de sorte que les arcs de sommets
+//! \brief de numéros voisins sont aussi voisins en mémoire; l'ordre des arcs de chaque liste est conservé
+//! \param[in] p_nouveauNumero: une permutation de 0..getNbSommets()-1
+//! \throws logic_error lorsque p_nouveauNumero n'est pas une permutation des sommets
+template<typename Sommet, typename Poids>
+void GrapheGenerique<Sommet, Poids>::renumeroter(const std::vector<size_t> &p_nouveauNumero)
+{
+    const size_t nbSommets = m_listesAdj.size();
+    if (p_nouveauNumero.size() != nbSommets)
+        throw logic_error("Graphe::renumeroter(): p_nouveauNumero doit avoir un numéro par sommet");
+    if (m_nbSommetsImage > 0)
+        throw logic_error("Graphe::renumeroter(): impossible de renuméroter un graphe attaché à une image");
+
+    vector<size_t> ancienNumero(nbSommets, numeric_limits<size_t>::max());
+    for (size_t i = 0; i < nbSommets; ++i)
+    {
+        if (p_nouveauNumero[i] >= nbSommets || ancienNumero[p_nouveauNumero[i]] != numeric_limits<size_t>::max())
+            throw logic_error("Graphe::renumeroter(): p_nouveauNumero n'est pas une permutation des sommets");
+        ancienNumero[p_nouveauNumero[i]] = i;
+    }
+
+    //les nouvelles listes sont dans une nouvelle arène; l'ancienne est rendue d'un coup avec les anciennes listes
+    shared_ptr<Arene> arene = make_shared<Arene>();
+    vector<ListeArcs> nouvellesListes(nbSommets, ListeArcs(AllocateurArene<Arc>(arene)));
+    for (size_t k = 0; k < nbSommets; ++k)
+    {
+        nouvellesListes[k].reserve(m_listesAdj[ancienNumero[k]].size());
+        for (auto &arc : m_listesAdj[ancienNumero[k]])
+        {
+            nouvellesListes[k].emplace_back(Arc(p_nouveauNumero[arc.destination], arc.poids));
+        }
+        m_listesAdj[ancienNumero[k]].clear();
+    }
+    m_listesAdj.swap(nouvellesListes);
+    m_arene = arene;
+    invaliderInverse();
+}
+
 //! \brief enlève un arc dans le graphe
 //! \param[in] i: le sommet origine de l'arc
 //! \param[in] j: le sommet destination de l'arc
@@ -63,12 +285,16 @@ void Graphe::ajouterArc(size_t i, size_t j, unsigned int poids)
 //! \post enlève l'arc mais n'enlève jamais le sommet i
 //! \throws logic_error lorsque le sommet i ou le sommet j n'existe pas
 //! \throws logic_error lorsque l'arc n'existe pas
-void Graphe::enleverArc(size_t i, size_t j)
+template<typename Sommet, typename Poids>
+void GrapheGenerique<Sommet, Poids>::enleverArc(size_t i, size_t j)
 {
     if (i >= m_listesAdj.size())
         throw logic_error("Graphe::enleverArc(): tentative d'enlever l'arc(i,j) avec un sommet i inexistant");
     if (j >= m_listesAdj.size())
         throw logic_error("Graphe::enleverArc(): tentative d'enlever l'arc(i,j) avec un sommet j inexistant");
+    if (i < m_nbSommetsImage)
+        throw logic_error("Graphe::enleverArc(): les arcs des sommets de l'image sont en lecture seule");
+    invaliderInverse(i);
     auto &liste = m_listesAdj[i];
     bool arc_enleve = false;
     for (auto itr = liste.end(); itr != liste.begin();) //on débute par la fin par choix
@@ -86,10 +312,57 @@ void Graphe::enleverArc(size_t i, size_t j)
 }
 
 
-unsigned int Graphe::getPoids(size_t i, size_t j) const
+//! \brief enlève tous les arcs sortant d'un sommet (par exemple pour les regénérer après une modification des données)
+//! \param[in] i: le sommet origine des arcs
+//! \post le sommet i n'a plus d'arc sortant, mais il reste dans le graphe
+//! \throws logic_error lorsque le sommet i n'existe pas ou appartient à l'image
+template<typename Sommet, typename Poids>
+void GrapheGenerique<Sommet, Poids>::enleverArcs(size_t i)
+{
+    if (i >= m_listesAdj.size())
+        throw logic_error("Graphe::enleverArcs(): le sommet i n'existe pas");
+    if (i < m_nbSommetsImage)
+        throw logic_error("Graphe::enleverArcs(): les arcs des sommets de l'image sont en lecture seule");
+    invaliderInverse(i);
+    nbArcs -= m_listesAdj[i].size();
+    m_listesAdj[i].clear();
+}
+
+//! \brief remplace le poids de l'arc (i,j) (le premier, s'il y en a plusieurs)
+//! \param[in] i: le sommet origine de l'arc
+//! \param[in] j: le sommet destination de l'arc
+//! \param[in] poids: le nouveau poids
+//! \throws logic_error lorsque le sommet i n'existe pas, appartient à l'image ou lorsque l'arc n'existe pas
+//! \throws logic_error lorsque poids == numeric_limits<unsigned int>::max() ou ne tient pas dans le type des poids
+template<typename Sommet, typename Poids>
+void GrapheGenerique<Sommet, Poids>::modifierPoids(size_t i, size_t j, unsigned int poids)
+{
+    if (i >= m_listesAdj.size())
+        throw logic_error("Graphe::modifierPoids(): le sommet i n'existe pas");
+    if (poids == numeric_limits<unsigned int>::max())
+        throw logic_error("Graphe::modifierPoids(): valeur de poids interdite");
+    if (poids > numeric_limits<Poids>::max())
+        throw logic_error("Graphe::modifierPoids(): poids trop grand pour le type des poids");
+    if (i < m_nbSommetsImage)
+        throw logic_error("Graphe::modifierPoids(): les arcs des sommets de l'image sont en lecture seule");
+    invaliderInverse(i);
+    for (auto &arc : m_listesAdj[i])
+    {
+        if (arc.destination == j)
+        {
+            arc.poids = poids;
+            return;
+        }
+    }
+    throw logic_error("Graphe::modifierPoids(): cet arc n'existe pas");
+}
+
+
+template<typename Sommet, typename Poids>
+unsigned int GrapheGenerique<Sommet, Poids>::getPoids(size_t i, size_t j) const
 {
     if (i >= m_listesAdj.size()) throw logic_error("Graphe::getPoids(): l'incice i n,est pas un sommet existant");
-    for (auto & arc : m_listesAdj[i])
+    for (auto & arc : voisins(i))
     {
         if (arc.destination == j) return arc.poids;
     }
@@ -103,7 +376,38 @@ unsigned int Graphe::getPoids(size_t i, size_t j) const
 //! \param[out] le chemin est retourné (un seul noeud si p_destination == p_origine ou si p_destination est inatteignable)
 //! \return la longueur du chemin (= numeric_limits<unsigned int>::max() si p_destination n'est pas atteignable)
 //! \throws logic_error lorsque p_origine ou p_destination n'existe pas
-unsigned int Graphe::plusCourtChemin(size_t p_origine, size_t p_destination, std::vector<size_t> &p_chemin) const
+template<typename Sommet, typename Poids>
+unsigned int GrapheGenerique<Sommet, Poids>::plusCourtChemin(size_t p_origine, size_t p_destination, std::vector<size_t> &p_chemin) const
+{
+    SansStatistiques aucune;
+    return plusCourtCheminCompte(p_origine, p_destination, p_chemin, aucune);
+}
+
+//! \brief comme plusCourtChemin(), en mesurant aussi l'effort de la recherche
+//! \param[out] p_statistiques: sommets solutionnés, arcs relâchés, insertions dans la file, entrées périmées,
+//! \brief taille maximale de la file et mémoire de travail de cette recherche
+template<typename Sommet, typename Poids>
+unsigned int GrapheGenerique<Sommet, Poids>::plusCourtChemin(size_t p_origine, size_t p_destination,
+                                                             std::vector<size_t> &p_chemin,
+                                                             StatistiquesRecherche &p_statistiques) const
+{
+    p_statistiques = StatistiquesRecherche();
+    return plusCourtCheminCompte(p_origine, p_destination, p_chemin, p_statistiques);
+}
+
+//! \brief le nom de l'implantation de plusCourtChemin(): un monceau binaire (std::priority_queue) de sommets
+template<typename Sommet, typename Poids>
+const char * GrapheGenerique<Sommet, Poids>::getNomPlusCourtChemin()
+{
+    return "monceau";
+}
+
+//! \brief corps de plusCourtChemin(); Statistiques est SansStatistiques ou StatistiquesRecherche
+template<typename Sommet, typename Poids>
+template<typename Statistiques>
+unsigned int GrapheGenerique<Sommet, Poids>::plusCourtCheminCompte(size_t p_origine, size_t p_destination,
+                                                                    std::vector<size_t> &p_chemin,
+                                                                    Statistiques &p_statistiques) const
 {
     if (p_origine >= m_listesAdj.size() || p_destination >= m_listesAdj.size())
         throw logic_error("Graphe::dijkstra(): p_origine ou p_destination n'existe pas");
@@ -119,7 +423,7 @@ unsigned int Graphe::plusCourtChemin(size_t p_origine, size_t p_destination, std
 
     //Structure de données pour les noeuds de l'algorithme
     struct Noeud {
-        size_t numNoeud;
+        Sommet numNoeud;
         unsigned int distance;
     };
     //Comparateur pour maintenir l'ordre de la fille de priorité
@@ -133,12 +437,13 @@ unsigned int Graphe::plusCourtChemin(size_t p_origine, size_t p_destination, std
 
     //Containers pour réaliser le travail et le résultat de l'algorithme
     vector<unsigned int> distance(m_listesAdj.size(), numeric_limits<unsigned int>::max());
-    vector<size_t> predecesseur(m_listesAdj.size(), numeric_limits<size_t>::max());
+    vector<Sommet> predecesseur(m_listesAdj.size(), numeric_limits<Sommet>::max());
     vector<bool> visite(m_listesAdj.size(), false);
 
     //On ajoute le noeud de départ
     distance[p_origine] = 0;
-    q.push(Noeud{p_origine, 0});
+    q.push(Noeud{(Sommet) p_origine, 0});
+    p_statistiques.empiler(q.size());
     
     //Boucle principale: trouver distance[] et predecesseur[]
     while (!q.empty())
@@ -148,14 +453,17 @@ unsigned int Graphe::plusCourtChemin(size_t p_origine, size_t p_destination, std
         q.pop();
         size_t numNoeud = u.numNoeud;
 
-        //On marque le noeud visité
+        //On marque le noeud visité; une entrée d'un noeud déjà visité est périmée
+        if (visite[numNoeud]) p_statistiques.retirerPerimee();
+        else p_statistiques.solutionner();
         visite[numNoeud] = true;
 
         if (numNoeud == p_destination) break; //car on a obtenu distance[p_destination] et predecesseur[p_destination]
 
         //On effectue le relachement et identifie le voisin le plus près
-        for (auto u2 = m_listesAdj[numNoeud].begin(); u2 != m_listesAdj[numNoeud].end(); ++u2)
+        for (auto u2 = voisins(numNoeud).begin(); u2 != voisins(numNoeud).end(); ++u2)
         {
+            p_statistiques.relacher();
             if (!visite[u2->destination]) {
                 unsigned int nouvelleDistance = distance[numNoeud] + u2->poids;
 
@@ -164,14 +472,18 @@ unsigned int Graphe::plusCourtChemin(size_t p_origine, size_t p_destination, std
                     distance[u2->destination] = nouvelleDistance;
                     Noeud n2 {u2->destination, nouvelleDistance};
                     q.push(n2);
+                    p_statistiques.empiler(q.size());
                     predecesseur[u2->destination] = u.numNoeud;
                 }
             }
         }
     }
     
+    p_statistiques.terminer(distance.size() * (sizeof(unsigned int) + sizeof(Sommet)) + distance.size() / 8,
+                            sizeof(Noeud));
+
     //cas où l'on n'a pas de solution
-    if (predecesseur[p_destination] == numeric_limits<unsigned int>::max())
+    if (predecesseur[p_destination] == numeric_limits<Sommet>::max())
     {
         p_chemin.push_back(p_destination);
         return numeric_limits<unsigned int>::max();
@@ -181,7 +493,7 @@ unsigned int Graphe::plusCourtChemin(size_t p_origine, size_t p_destination, std
     stack<size_t> pileDuChemin;
     size_t numero = p_destination;
     pileDuChemin.push(numero);
-    while (predecesseur[numero] != numeric_limits<size_t>::max())
+    while (predecesseur[numero] != numeric_limits<Sommet>::max())
     {
         numero = predecesseur[numero];
         pileDuChemin.push(numero);
@@ -195,3 +507,277 @@ unsigned int Graphe::plusCourtChemin(size_t p_origine, size_t p_destination, std
     return distance[p_destination];
 }
 
+//! \brief construit le graphe inversé de tous les sommets actuels: les arcs entrant dans chaque sommet, dans l'ordre
+//! \brief croissant de leur origine
+template<typename Sommet, typename Poids>
+shared_ptr<const typename GrapheGenerique<Sommet, Poids>::GrapheInverse>
+GrapheGenerique<Sommet, Poids>::construireInverse() const
+{
+    const size_t nbSommets = m_listesAdj.size();
+    shared_ptr<GrapheInverse> inverse = make_shared<GrapheInverse>();
+    inverse->nbSommets = nbSommets;
+    inverse->debut.assign(nbSommets + 1, 0);
+    for (size_t i = 0; i < nbSommets; ++i)
+        for (auto &arc : voisins(i)) ++inverse->debut[arc.destination + 1];
+    for (size_t i = 0; i < nbSommets; ++i) inverse->debut[i + 1] += inverse->debut[i];
+
+    vector<size_t> position(inverse->debut.begin(), inverse->debut.end() - 1);
+    inverse->arcs.assign(inverse->debut[nbSommets], Arc(0, 0));
+    for (size_t i = 0; i < nbSommets; ++i)
+        for (auto &arc : voisins(i)) inverse->arcs[position[arc.destination]++] = Arc((Sommet) i, arc.poids);
+    return inverse;
+}
+
+//! \brief Algorithme de Dijkstra sur le graphe inversé: trouve la longueur du plus court chemin de chaque sommet vers
+//! \brief l'ensemble des sommets de p_destinations (chacun ayant un coût final qui s'ajoute à la longueur du chemin)
+//! \brief Une seule exécution donne l'information pour tous les sommets origines (utile pour les requêtes de profil)
+//! \brief Le graphe inversé est construit au premier appel et réutilisé par les suivants tant que les arcs des sommets
+//! \brief qu'il couvre ne changent pas; les arcs des sommets ajoutés depuis (ex.: le point origine d'une requête) sont
+//! \brief inversés à chaque appel.
+//! \param[in] p_destinations: les paires (sommet destination, coût final de ce sommet)
+//! \param[out] p_distance: p_distance[i] est la longueur du plus court chemin de i vers une destination (= numeric_limits<unsigned int>::max() si inatteignable)
+//! \param[out] p_successeur: p_successeur[i] est le sommet qui suit i sur ce chemin (= numeric_limits<size_t>::max() pour une destination ou si inatteignable)
+//! \throws logic_error lorsqu'une des destinations n'existe pas
+template<typename Sommet, typename Poids>
+void GrapheGenerique<Sommet, Poids>::plusCourtsCheminsVers(const std::vector<std::pair<size_t, unsigned int> > &p_destinations,
+                                   std::vector<unsigned int> &p_distance, std::vector<size_t> &p_successeur) const
+{
+    shared_ptr<const GrapheInverse> inverse = atomic_load(&m_inverse);
+    if (!inverse)
+    {
+        inverse = construireInverse();
+        atomic_store(&m_inverse, inverse);
+    }
+
+    //les arcs sortant des sommets ajoutés après la construction du graphe inversé: (destination, Arc(origine, poids))
+    typedef pair<Sommet, Arc> ArcInverse;
+    vector<ArcInverse> arcsAjoutes;
+    for (size_t i = inverse->nbSommets; i < m_listesAdj.size(); ++i)
+        for (auto &arc : voisins(i)) arcsAjoutes.push_back(ArcInverse(arc.destination, Arc((Sommet) i, arc.poids)));
+    auto parDestination = [](const ArcInverse &a, const ArcInverse &b) { return a.first < b.first; };
+    stable_sort(arcsAjoutes.begin(), arcsAjoutes.end(), parDestination);
+
+    p_distance.assign(m_listesAdj.size(), numeric_limits<unsigned int>::max());
+    p_successeur.assign(m_listesAdj.size(), numeric_limits<size_t>::max());
+
+    typedef pair<unsigned int, Sommet> Noeud; //(distance, sommet)
+    priority_queue<Noeud, vector<Noeud>, greater<Noeud> > q;
+
+    for (auto &destination : p_destinations)
+    {
+        if (destination.first >= m_listesAdj.size())
+            throw logic_error("Graphe::plusCourtsCheminsVers(): une des destinations n'existe pas");
+        if (destination.second < p_distance[destination.first])
+        {
+            p_distance[destination.first] = destination.second;
+            q.push(Noeud(destination.second, destination.first));
+        }
+    }
+
+    auto relacher = [&](const Noeud &u, const Arc &arc) {
+        unsigned int nouvelleDistance = u.first + arc.poids;
+        if (nouvelleDistance < p_distance[arc.destination])
+        {
+            p_distance[arc.destination] = nouvelleDistance;
+            p_successeur[arc.destination] = u.second;
+            q.push(Noeud(nouvelleDistance, arc.destination));
+        }
+    };
+    while (!q.empty())
+    {
+        Noeud u = q.top();
+        q.pop();
+        if (u.first > p_distance[u.second]) continue; //entrée périmée de la file
+
+        if (u.second < inverse->nbSommets)
+        {
+            for (size_t k = inverse->debut[u.second]; k < inverse->debut[u.second + 1]; ++k)
+                relacher(u, inverse->arcs[k]);
+        }
+        if (arcsAjoutes.empty()) continue;
+        auto ajoutes = equal_range(arcsAjoutes.begin(), arcsAjoutes.end(), ArcInverse(u.second, Arc(0, 0)),
+                                   parDestination);
+        for (auto arc = ajoutes.first; arc != ajoutes.second; ++arc) relacher(u, arc->second);
+    }
+}
+
+//! \brief Algorithme de Dijkstra à destinations multiples: une seule recherche à partir de p_origine
+//! \brief qui se termine dès que toutes les destinations de p_destinations sont solutionnées
+//! \pre p_origine et les sommets de p_destinations doivent être des sommets du graphe
+//! \param[out] p_chemins: p_chemins[k] est le chemin vers p_destinations[k] (un seul noeud si p_destinations[k] == p_origine ou s'il est inatteignable)
+//! \param[out] p_longueurs: p_longueurs[k] est la longueur de ce chemin (= numeric_limits<unsigned int>::max() si inatteignable)
+//! \throws logic_error lorsque p_origine ou un des sommets de p_destinations n'existe pas
+template<typename Sommet, typename Poids>
+void GrapheGenerique<Sommet, Poids>::plusCourtsChemins(size_t p_origine, const std::vector<size_t> &p_destinations,
+                               std::vector<std::vector<size_t> > &p_chemins,
+                               std::vector<unsigned int> &p_longueurs) const
+{
+    SansElagage elagage;
+    plusCourtsCheminsElague(p_origine, p_destinations, p_chemins, p_longueurs, elagage);
+}
+
+//! \brief Algorithme de Dijkstra à sources multiples: trouve la longueur du plus court chemin vers tous les sommets atteignables
+//! \brief Les tampons de p_espace sont réutilisés d'un appel à l'autre (un espace par thread); seuls les sommets
+//! \brief atteints lors de l'appel précédent sont réinitialisés
+//! \param[in] p_sources: les paires (sommet source, distance initiale de ce sommet)
+//! \param[in,out] p_espace: l'espace de travail; en sortie, p_espace.distance[i] est la longueur du plus court chemin vers i
+//! \param[in] p_borne: la recherche s'arrête dès que cette distance est dépassée (les sommets plus éloignés ne sont pas atteints)
+//! \post p_espace.distance[i] == numeric_limits<unsigned int>::max() si i est inatteignable (ou au-delà de p_borne);
+//! \post p_espace.sommetsAtteints contient les autres
+//! \throws logic_error lorsqu'une des sources n'existe pas
+template<typename Sommet, typename Poids>
+void GrapheGenerique<Sommet, Poids>::plusCourtsCheminsDepuis(const std::vector<std::pair<size_t, unsigned int> > &p_sources,
+                                     EspaceRecherche &p_espace, unsigned int p_borne) const
+{
+    if (p_espace.distance.size() != m_listesAdj.size())
+    {
+        p_espace.distance.assign(m_listesAdj.size(), numeric_limits<unsigned int>::max());
+    } else
+    {
+        for (auto sommet : p_espace.sommetsAtteints) p_espace.distance[sommet] = numeric_limits<unsigned int>::max();
+    }
+    p_espace.sommetsAtteints.clear();
+    p_espace.file.clear();
+
+    vector<unsigned int> &distance = p_espace.distance;
+    vector<pair<unsigned int, Sommet> > &q = p_espace.file; //tas binaire de paires (distance, sommet)
+    greater<pair<unsigned int, Sommet> > comp;
+
+    for (auto &source : p_sources)
+    {
+        if (source.first >= m_listesAdj.size())
+            throw logic_error("Graphe::plusCourtsCheminsDepuis(): une des sources n'existe pas");
+        if (source.second <= p_borne && source.second < distance[source.first])
+        {
+            if (distance[source.first] == numeric_limits<unsigned int>::max())
+                p_espace.sommetsAtteints.push_back(source.first);
+            distance[source.first] = source.second;
+            q.push_back(make_pair(source.second, source.first));
+            push_heap(q.begin(), q.end(), comp);
+        }
+    }
+
+    while (!q.empty())
+    {
+        pop_heap(q.begin(), q.end(), comp);
+        pair<unsigned int, Sommet> u = q.back();
+        q.pop_back();
+        if (u.first > distance[u.second]) continue; //entrée périmée de la file
+
+        for (auto &arc : voisins(u.second))
+        {
+            unsigned int nouvelleDistance = u.first + arc.poids;
+            if (nouvelleDistance <= p_borne && nouvelleDistance < distance[arc.destination])
+            {
+                if (distance[arc.destination] == numeric_limits<unsigned int>::max())
+                    p_espace.sommetsAtteints.push_back(arc.destination);
+                distance[arc.destination] = nouvelleDistance;
+                q.push_back(make_pair(nouvelleDistance, arc.destination));
+                push_heap(q.begin(), q.end(), comp);
+            }
+        }
+    }
+}
+
+//! \brief écrit l'image binaire du graphe, indépendante de sa position en mémoire (des indices plutôt que des pointeurs)
+//! \brief Format (ordre des octets de la machine): nbSommets, nbArcs, sizeof(Sommet), sizeof(Poids) sur 8 octets chacun,
+//! \brief puis les nbSommets + 1 indices (8 octets) du début des arcs de chaque sommet, puis les arcs (Sommet, Poids),
+//! \brief complétés par des zéros jusqu'à un multiple de 8 octets
+//! \brief Chaque arc est écrit champ par champ dans un tampon mis à zéro: les octets de remplissage de Arc, que le
+//! \brief compilateur ne garantit pas, sont des zéros plutôt que le contenu de la mémoire
+//! \param[out] p_sortie: un flux binaire
+//! \throws logic_error si l'écriture échoue
+template<typename Sommet, typename Poids>
+void GrapheGenerique<Sommet, Poids>::ecrireImage(std::ostream &p_sortie) const
+{
+    const uint64_t entete[4] = {m_listesAdj.size(), nbArcs, sizeof(Sommet), sizeof(Poids)};
+    p_sortie.write(reinterpret_cast<const char *>(entete), sizeof(entete));
+
+    uint64_t debut = 0;
+    for (size_t i = 0; i < m_listesAdj.size(); ++i)
+    {
+        p_sortie.write(reinterpret_cast<const char *>(&debut), sizeof(debut));
+        debut += voisins(i).end() - voisins(i).begin();
+    }
+    p_sortie.write(reinterpret_cast<const char *>(&debut), sizeof(debut));
+
+    vector<char> tampon;
+    for (size_t i = 0; i < m_listesAdj.size(); ++i)
+    {
+        Voisins v = voisins(i);
+        tampon.assign((v.end() - v.begin()) * sizeof(Arc), 0);
+        char *position = tampon.data();
+        for (const Arc &arc : v)
+        {
+            memcpy(position + offsetof(Arc, destination), &arc.destination, sizeof(Sommet));
+            memcpy(position + offsetof(Arc, poids), &arc.poids, sizeof(Poids));
+            position += sizeof(Arc);
+        }
+        p_sortie.write(tampon.data(), tampon.size());
+    }
+    const char zeros[8] = {0};
+    p_sortie.write(zeros, (8 - (debut * sizeof(Arc)) % 8) % 8);
+
+    if (!p_sortie) throw logic_error("Graphe::ecrireImage(): l'écriture de l'image a échoué");
+}
+
+//! \brief attache le graphe à une image produite par ecrireImage() (par exemple un fichier projeté en mémoire avec mmap)
+//! \brief Les arcs sont lus directement dans l'image, qui n'est jamais copiée ni modifiée; plusieurs processus qui projettent
+//! \brief le même fichier partagent donc une seule copie physique. Les sommets ajoutés ensuite par resize() ont des listes
+//! \brief d'adjacence ordinaires.
+//! \param[in] p_image: le début de l'image, aligné sur 8 octets; elle doit survivre au graphe
+//! \param[in] p_taille: le nombre d'octets disponibles à partir de p_image
+//! \return le nombre d'octets occupés par l'image du graphe (multiple de 8)
+//! \post les arcs précédents du graphe sont remplacés par ceux de l'image
+//! \throws logic_error si l'image est tronquée ou incompatible avec les types Sommet et Poids
+//! \throws logic_error si les indices de début ne sont pas croissants de 0 à nbArcs ou si un arc mène à un sommet
+//! \brief inexistant: chaque indice et chaque arc sont lus une fois, de sorte qu'une image corrompue est refusée ici
+//! \brief plutôt que de faire lire une recherche hors de l'image
+template<typename Sommet, typename Poids>
+size_t GrapheGenerique<Sommet, Poids>::attacherImage(const char *p_image, size_t p_taille)
+{
+    if (reinterpret_cast<uintptr_t>(p_image) % 8 != 0)
+        throw logic_error("Graphe::attacherImage(): l'image doit être alignée sur 8 octets");
+    const uint64_t *entete = reinterpret_cast<const uint64_t *>(p_image);
+    if (p_taille < 4 * sizeof(uint64_t))
+        throw logic_error("Graphe::attacherImage(): image tronquée");
+    if (entete[2] != sizeof(Sommet) || entete[3] != sizeof(Poids))
+        throw logic_error("Graphe::attacherImage(): l'image a été produite pour d'autres types de sommets ou de poids");
+
+    //les tailles sont bornées par p_taille avant d'être multipliées, pour qu'une image corrompue ne les fasse pas déborder
+    if (entete[0] > numeric_limits<Sommet>::max() || entete[0] >= p_taille / sizeof(uint64_t) ||
+        entete[1] > p_taille / sizeof(Arc))
+        throw logic_error("Graphe::attacherImage(): image tronquée");
+    const size_t nbSommets = entete[0];
+    const size_t tailleArcs = (entete[1] * sizeof(Arc) + 7) / 8 * 8;
+    const size_t taille = (4 + nbSommets + 1) * sizeof(uint64_t) + tailleArcs;
+    if (p_taille < taille)
+        throw logic_error("Graphe::attacherImage(): image tronquée");
+
+    const uint64_t *debutArcs = entete + 4;
+    if (debutArcs[0] != 0 || debutArcs[nbSommets] != entete[1])
+        throw logic_error("Graphe::attacherImage(): image incohérente");
+    for (size_t i = 0; i < nbSommets; ++i)
+    {
+        if (debutArcs[i] > debutArcs[i + 1])
+            throw logic_error("Graphe::attacherImage(): les indices de début des arcs ne sont pas croissants");
+    }
+    const Arc *arcs = reinterpret_cast<const Arc *>(debutArcs + nbSommets + 1);
+    for (size_t k = 0; k < entete[1]; ++k)
+    {
+        if (arcs[k].destination >= nbSommets)
+            throw logic_error("Graphe::attacherImage(): un arc de l'image mène à un sommet inexistant");
+    }
+
+    invaliderInverse();
+    m_listesAdj.assign(nbSommets, ListeArcs());
+    nbArcs = entete[1];
+    m_nbSommetsImage = nbSommets;
+    m_debutArcsImage = debutArcs;
+    m_arcsImage = arcs;
+    return taille;
+}
+
+//instanciation des représentations offertes (voir graphe.h)
+template class GrapheGenerique<size_t, unsigned int>;
+template class GrapheGenerique<uint32_t, uint32_t>;
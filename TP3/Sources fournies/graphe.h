@@ -15,38 +15,384 @@
 #include <iostream>
 #include <algorithm>
 #include <queue>
+#include <stdexcept>
+#include <functional>
+#include <cstdint>
+#include <memory>
+#include "arene.h"
 
 //! \brief  Classe pour graphes orientés pondérés (non négativement) avec listes d'adjacence
-class Graphe
+//! \brief  Sommet est le type entier des numéros de sommets stockés (arcs, prédécesseurs, file de priorité) et Poids celui
+//! \brief  des poids stockés dans les arcs; les longueurs de chemins sont toujours des unsigned int. Les types compacts
+//! \brief  réduisent la mémoire lue à chaque parcours d'une liste d'adjacence (voir les typedef à la fin du fichier).
+template<typename Sommet, typename Poids>
+class GrapheGenerique
 {
 public:
 
-	Graphe(size_t = 0);
+    //! \brief espace de travail réutilisable d'une recherche (un par thread lorsque plusieurs recherches sont concurrentes)
+    struct EspaceRecherche
+    {
+        std::vector<unsigned int> distance; //distance[i] est la longueur du plus court chemin vers i
+        std::vector<Sommet> sommetsAtteints; //les sommets dont la distance est finie
+        std::vector<std::pair<unsigned int, Sommet> > file; //le tas binaire de la recherche
+    };
+
+    //! \brief un arc produit hors du graphe (par exemple dans le tampon d'un thread) en vue de son ajout par ajouterArcs()
+    struct ArcAAjouter
+    {
+        size_t origine;
+        size_t destination;
+        unsigned int poids;
+    };
+
+    //! \brief politique d'élagage de plusCourtCheminElague() qui n'élague aucun arc
+    struct SansElagage
+    {
+        void solutionner(size_t, unsigned int) {}
+        bool relacher(size_t, size_t, unsigned int) { return true; }
+        const std::vector<std::pair<size_t, unsigned int> > &arcsImplicites(size_t)
+        {
+            static const std::vector<std::pair<size_t, unsigned int> > aucun;
+            return aucun;
+        }
+    };
+
+    //! \brief politique de statistiques des recherches qui ne compte rien: ses appels vides disparaissent à la compilation
+    struct SansStatistiques
+    {
+        void solutionner() {}
+        void relacher() {}
+        void empiler(size_t) {}
+        void retirerPerimee() {}
+        void terminer(size_t, size_t) {}
+    };
+
+    //! \brief politique de statistiques qui mesure l'effort d'une recherche
+    struct StatistiquesRecherche
+    {
+        StatistiquesRecherche() : sommetsSolutionnes(0), relachements(0), empilements(0), entreesPerimees(0),
+                                  tailleMaxFile(0), octetsTravail(0) {}
+        size_t sommetsSolutionnes; //les sommets retirés de la file et solutionnés
+        size_t relachements; //les arcs (y compris implicites) examinés à partir des sommets solutionnés
+        //la liste de plusCourtChemin() au TP2 n'est pas une file de priorité: ces trois compteurs y valent 0
+        size_t empilements; //les insertions dans la file de priorité
+        size_t entreesPerimees; //les entrées retirées de la file alors que leur sommet était déjà solutionné
+        size_t tailleMaxFile; //le nombre maximal d'entrées dans la file
+        size_t octetsTravail; //la mémoire de travail: tableaux indexés par sommet et file à sa taille maximale
+
+        void solutionner() { ++sommetsSolutionnes; }
+        void relacher() { ++relachements; }
+        void empiler(size_t p_taille) { ++empilements; if (p_taille > tailleMaxFile) tailleMaxFile = p_taille; }
+        void retirerPerimee() { ++entreesPerimees; }
+        void terminer(size_t p_octetsTableaux, size_t p_octetsParEntree)
+        {
+            octetsTravail = p_octetsTableaux + tailleMaxFile * p_octetsParEntree;
+        }
+    };
+
+	GrapheGenerique(size_t = 0);
+    GrapheGenerique(const GrapheGenerique &);
+    GrapheGenerique & operator=(const GrapheGenerique &);
     void resize(size_t);
 	void ajouterArc(size_t i, size_t j, unsigned int poids);
+    void ajouterArcs(const std::vector<std::vector<ArcAAjouter> > & p_tampons, unsigned int p_nbThreads);
+    void renumeroter(const std::vector<size_t> & p_nouveauNumero);
+    void ecrireImage(std::ostream & p_sortie) const;
+    size_t attacherImage(const char * p_image, size_t p_taille);
 	void enleverArc(size_t i, size_t j);
+    void enleverArcs(size_t i);
+    void modifierPoids(size_t i, size_t j, unsigned int poids);
 	unsigned int getPoids(size_t i, size_t j) const;
 	size_t getNbSommets() const;
     size_t getNbArcs() const;
+    size_t getOctetsListesAdj() const;
+    size_t getOctetsImage() const;
+    size_t getOctetsGrapheInverse() const;
+    static const char * getNomPlusCourtChemin();
 
     unsigned int plusCourtChemin(size_t p_origine, size_t p_destination,
                              std::vector<size_t> & p_chemin) const;
+    unsigned int plusCourtChemin(size_t p_origine, size_t p_destination,
+                                 std::vector<size_t> & p_chemin, StatistiquesRecherche & p_statistiques) const;
+    template<typename Elagage>
+    unsigned int plusCourtCheminElague(size_t p_origine, size_t p_destination,
+                                       std::vector<size_t> & p_chemin, Elagage & p_elagage) const
+    {
+        SansStatistiques aucune;
+        return plusCourtCheminElague(p_origine, p_destination, p_chemin, p_elagage, aucune);
+    }
+    template<typename Elagage, typename Statistiques>
+    unsigned int plusCourtCheminElague(size_t p_origine, size_t p_destination, std::vector<size_t> & p_chemin,
+                                       Elagage & p_elagage, Statistiques & p_statistiques) const;
+    void plusCourtsChemins(size_t p_origine, const std::vector<size_t> & p_destinations,
+                           std::vector<std::vector<size_t> > & p_chemins,
+                           std::vector<unsigned int> & p_longueurs) const;
+    template<typename Elagage>
+    void plusCourtsCheminsElague(size_t p_origine, const std::vector<size_t> & p_destinations,
+                                 std::vector<std::vector<size_t> > & p_chemins,
+                                 std::vector<unsigned int> & p_longueurs, Elagage & p_elagage) const;
+    void plusCourtsCheminsVers(const std::vector<std::pair<size_t, unsigned int> > & p_destinations,
+                               std::vector<unsigned int> & p_distance, std::vector<size_t> & p_successeur) const;
+    void plusCourtsCheminsDepuis(const std::vector<std::pair<size_t, unsigned int> > & p_sources,
+                                 EspaceRecherche & p_espace,
+                                 unsigned int p_borne = std::numeric_limits<unsigned int>::max()) const;
 
 private:
 
 	struct Arc
 	{
-        Arc(size_t dest, unsigned int p) :
+		Arc(Sommet dest, Poids p) :
 				destination(dest), poids(p)
 		{
 		}
-        size_t destination;
-        unsigned int poids;
+		Sommet destination;
+		Poids poids;
 	};
 
 
-	std::vector<std::list<Arc> > m_listesAdj; /*!< les listes d'adjacence */
+    //une liste remplie par ajouterArcs() est dans m_arene, réservée à sa taille exacte; celles des sommets ajoutés
+    //ensuite (ex.: les points origine et destination d'une requête) sont sur le tas, pour être vraiment libérées
+    typedef std::vector<Arc, AllocateurArene<Arc> > ListeArcs;
+
+    std::shared_ptr<Arene> m_arene;
+	std::vector<ListeArcs> m_listesAdj; /*!< les listes d'adjacence (contiguës) */
     unsigned long nbArcs;
+
+    //image en lecture seule (voir attacherImage()): les arcs des sommets 0..m_nbSommetsImage-1 sont dans m_arcsImage,
+    //de m_arcsImage[m_debutArcsImage[i]] à m_arcsImage[m_debutArcsImage[i+1]] exclusivement
+    size_t m_nbSommetsImage;
+    const uint64_t *m_debutArcsImage;
+    const Arc *m_arcsImage;
+
+    //! \brief le graphe inversé de plusCourtsCheminsVers(), en tableaux contigus: les arcs entrant dans le sommet i sont
+    //! \brief arcs[debut[i]] à arcs[debut[i+1]] exclusivement, chacun donnant l'origine de l'arc et son poids
+    struct GrapheInverse
+    {
+        size_t nbSommets; //les sommets couverts, 0..nbSommets-1: tous les arcs qui en sortaient à la construction
+        std::vector<size_t> debut;
+        std::vector<Arc> arcs;
+    };
+
+    //construit au premier appel de plusCourtsCheminsVers() puis réutilisé, jusqu'à ce que les arcs sortant d'un sommet
+    //couvert changent (voir invaliderInverse()); lu et remplacé par std::atomic_load() et std::atomic_store(), de sorte
+    //que les méthodes const restent sûres entre threads
+    mutable std::shared_ptr<const GrapheInverse> m_inverse;
+
+    //! \brief oublie le graphe inversé lorsque les arcs sortant de p_sommet y sont (tous les sommets par défaut)
+    void invaliderInverse(size_t p_sommet = 0)
+    {
+        if (m_inverse && p_sommet < m_inverse->nbSommets) m_inverse.reset();
+    }
+
+    std::shared_ptr<const GrapheInverse> construireInverse() const;
+
+    //! \brief intervalle [debut, fin) des arcs sortant d'un sommet, qu'ils soient dans l'image ou dans m_listesAdj
+    struct Voisins
+    {
+        const Arc *debut;
+        const Arc *fin;
+        const Arc *begin() const { return debut; }
+        const Arc *end() const { return fin; }
+    };
+
+    template<typename Statistiques>
+    unsigned int plusCourtCheminCompte(size_t p_origine, size_t p_destination, std::vector<size_t> & p_chemin,
+                                       Statistiques & p_statistiques) const;
+
+    Voisins voisins(size_t p_sommet) const
+    {
+        if (p_sommet < m_nbSommetsImage)
+            return Voisins{m_arcsImage + m_debutArcsImage[p_sommet], m_arcsImage + m_debutArcsImage[p_sommet + 1]};
+        return Voisins{m_listesAdj[p_sommet].data(), m_listesAdj[p_sommet].data() + m_listesAdj[p_sommet].size()};
+    }
 };
 
+//! \brief Algorithme de Dijkstra (avec tas binaire) permettant de trouver le plus court chemin entre p_origine et p_destination
+//! \brief en laissant une politique d'élagage écarter des relâchements d'arcs qu'elle sait dominés
+//! \brief La politique doit offrir solutionner(u, distance), appelée lorsque u est solutionné,
+//! \brief relacher(u, v, distance), appelée avant d'améliorer la distance de v par l'arc (u,v); false élague l'arc, et
+//! \brief arcsImplicites(u), les paires (v, poids) d'arcs qui ne sont pas dans le graphe mais qui sont relâchés
+//! \brief lorsque u est solutionné (par exemple les arcs vers un point destination)
+//! \brief La politique de statistiques (SansStatistiques ou StatistiquesRecherche) est informée de chaque étape
+//! \pre p_origine et p_destination doivent être des sommets du graphe
+//! \param[out] le chemin est retourné (un seul noeud si p_destination == p_origine ou si p_destination est inatteignable)
+//! \return la longueur du chemin (= numeric_limits<unsigned int>::max() si p_destination n'est pas atteignable)
+//! \throws logic_error lorsque p_origine ou p_destination n'existe pas
+template<typename Sommet, typename Poids>
+template<typename Elagage, typename Statistiques>
+unsigned int GrapheGenerique<Sommet, Poids>::plusCourtCheminElague(size_t p_origine, size_t p_destination,
+                                                                    std::vector<size_t> &p_chemin,
+                                                                    Elagage &p_elagage,
+                                                                    Statistiques &p_statistiques) const
+{
+    if (p_origine >= m_listesAdj.size() || p_destination >= m_listesAdj.size())
+        throw std::logic_error("Graphe::plusCourtCheminElague(): p_origine ou p_destination n'existe pas");
+
+    p_chemin.clear();
+
+    std::vector<unsigned int> distance(m_listesAdj.size(), std::numeric_limits<unsigned int>::max());
+    std::vector<Sommet> predecesseur(m_listesAdj.size(), std::numeric_limits<Sommet>::max());
+
+    typedef std::pair<unsigned int, Sommet> Noeud; //(distance, sommet)
+    std::priority_queue<Noeud, std::vector<Noeud>, std::greater<Noeud> > q;
+
+    distance[p_origine] = 0;
+    q.push(Noeud(0, p_origine));
+    p_statistiques.empiler(q.size());
+
+    while (!q.empty())
+    {
+        Noeud u = q.top();
+        q.pop();
+        if (u.first > distance[u.second]) //entrée périmée de la file
+        {
+            p_statistiques.retirerPerimee();
+            continue;
+        }
+        if (u.second == p_destination) break; //car on a obtenu distance[p_destination] et predecesseur[p_destination]
+
+        p_elagage.solutionner(u.second, u.first);
+        p_statistiques.solutionner();
+
+        for (auto &arc : voisins(u.second))
+        {
+            p_statistiques.relacher();
+            unsigned int nouvelleDistance = u.first + arc.poids;
+            if (nouvelleDistance < distance[arc.destination] &&
+                p_elagage.relacher(u.second, arc.destination, nouvelleDistance))
+            {
+                distance[arc.destination] = nouvelleDistance;
+                predecesseur[arc.destination] = u.second;
+                q.push(Noeud(nouvelleDistance, arc.destination));
+                p_statistiques.empiler(q.size());
+            }
+        }
+        for (auto &arc : p_elagage.arcsImplicites(u.second))
+        {
+            p_statistiques.relacher();
+            unsigned int nouvelleDistance = u.first + arc.second;
+            if (nouvelleDistance < distance[arc.first])
+            {
+                distance[arc.first] = nouvelleDistance;
+                predecesseur[arc.first] = u.second;
+                q.push(Noeud(nouvelleDistance, arc.first));
+                p_statistiques.empiler(q.size());
+            }
+        }
+    }
+    p_statistiques.terminer(distance.size() * (sizeof(unsigned int) + sizeof(Sommet)), sizeof(Noeud));
+
+    p_chemin.push_back(p_destination);
+    if (distance[p_destination] == std::numeric_limits<unsigned int>::max())
+        return std::numeric_limits<unsigned int>::max();
+
+    //On a une solution, donc construire le plus court chemin à l'aide de predecesseur[]
+    for (size_t numero = p_destination; predecesseur[numero] != std::numeric_limits<Sommet>::max();)
+    {
+        numero = predecesseur[numero];
+        p_chemin.push_back(numero);
+    }
+    std::reverse(p_chemin.begin(), p_chemin.end());
+    return distance[p_destination];
+}
+
+//! \brief Algorithme de Dijkstra à destinations multiples: une seule recherche à partir de p_origine
+//! \brief qui se termine dès que toutes les destinations de p_destinations sont solutionnées
+//! \brief Une politique d'élagage (voir plusCourtCheminElague()) peut écarter des arcs et en ajouter d'implicites
+//! \pre p_origine et les sommets de p_destinations doivent être des sommets du graphe
+//! \param[out] p_chemins: p_chemins[k] est le chemin vers p_destinations[k] (un seul noeud si p_destinations[k] == p_origine ou s'il est inatteignable)
+//! \param[out] p_longueurs: p_longueurs[k] est la longueur de ce chemin (= numeric_limits<unsigned int>::max() si inatteignable)
+//! \throws logic_error lorsque p_origine ou un des sommets de p_destinations n'existe pas
+template<typename Sommet, typename Poids>
+template<typename Elagage>
+void GrapheGenerique<Sommet, Poids>::plusCourtsCheminsElague(size_t p_origine, const std::vector<size_t> &p_destinations,
+                                                              std::vector<std::vector<size_t> > &p_chemins,
+                                                              std::vector<unsigned int> &p_longueurs,
+                                                              Elagage &p_elagage) const
+{
+    if (p_origine >= m_listesAdj.size())
+        throw std::logic_error("Graphe::plusCourtsCheminsElague(): p_origine n'existe pas");
+
+    std::vector<bool> estDestination(m_listesAdj.size(), false);
+    size_t nbRestantes = 0; //nombre de destinations distinctes non solutionnées
+    for (auto destination : p_destinations)
+    {
+        if (destination >= m_listesAdj.size())
+            throw std::logic_error("Graphe::plusCourtsCheminsElague(): une des destinations n'existe pas");
+        if (!estDestination[destination])
+        {
+            estDestination[destination] = true;
+            ++nbRestantes;
+        }
+    }
+
+    std::vector<unsigned int> distance(m_listesAdj.size(), std::numeric_limits<unsigned int>::max());
+    std::vector<Sommet> predecesseur(m_listesAdj.size(), std::numeric_limits<Sommet>::max());
+
+    typedef std::pair<unsigned int, Sommet> Noeud; //(distance, sommet)
+    std::priority_queue<Noeud, std::vector<Noeud>, std::greater<Noeud> > q;
+
+    distance[p_origine] = 0;
+    q.push(Noeud(0, p_origine));
+
+    while (!q.empty() && nbRestantes > 0)
+    {
+        Noeud u = q.top();
+        q.pop();
+        if (u.first > distance[u.second]) continue; //entrée périmée de la file
+
+        if (estDestination[u.second])
+        {
+            estDestination[u.second] = false;
+            --nbRestantes;
+        }
+        p_elagage.solutionner(u.second, u.first);
+
+        for (auto &arc : voisins(u.second))
+        {
+            unsigned int nouvelleDistance = u.first + arc.poids;
+            if (nouvelleDistance < distance[arc.destination] &&
+                p_elagage.relacher(u.second, arc.destination, nouvelleDistance))
+            {
+                distance[arc.destination] = nouvelleDistance;
+                predecesseur[arc.destination] = u.second;
+                q.push(Noeud(nouvelleDistance, arc.destination));
+            }
+        }
+        for (auto &arc : p_elagage.arcsImplicites(u.second))
+        {
+            unsigned int nouvelleDistance = u.first + arc.second;
+            if (nouvelleDistance < distance[arc.first])
+            {
+                distance[arc.first] = nouvelleDistance;
+                predecesseur[arc.first] = u.second;
+                q.push(Noeud(nouvelleDistance, arc.first));
+            }
+        }
+    }
+
+    //construire chacun des chemins à l'aide de predecesseur[]
+    p_chemins.assign(p_destinations.size(), std::vector<size_t>());
+    p_longueurs.assign(p_destinations.size(), std::numeric_limits<unsigned int>::max());
+    for (size_t k = 0; k < p_destinations.size(); ++k)
+    {
+        size_t numero = p_destinations[k];
+        p_longueurs[k] = distance[numero];
+        p_chemins[k].push_back(numero);
+        if (distance[numero] == std::numeric_limits<unsigned int>::max()) continue;
+        while (predecesseur[numero] != std::numeric_limits<Sommet>::max())
+        {
+            numero = predecesseur[numero];
+            p_chemins[k].push_back(numero);
+        }
+        std::reverse(p_chemins[k].begin(), p_chemins[k].end());
+    }
+}
+
+//! \brief représentation d'origine: numéros de sommets size_t et poids unsigned int
+typedef GrapheGenerique<size_t, unsigned int> Graphe;
+//! \brief représentation compacte: numéros de sommets et poids sur 32 bits (arcs de 8 octets au lieu de 16)
+typedef GrapheGenerique<uint32_t, uint32_t> GrapheCompact;
+
 #endif  //GRAPH_H
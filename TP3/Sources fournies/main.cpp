@@ -2,16 +2,27 @@
 // Produced by Mario on Dec 2016.
 //
 
+#include <chrono>
 #include <iostream>
 #include <random>
 
 #include "DonneesGTFS.h"
 #include "ReseauGTFS.h"
+#include "trace.h"
 
 using namespace std;
 
-int main()
+//! \brief usage: main [fichier_trace]
+//! \brief Chaque itinéraire est trouvé par le moteur de production (ReseauGTFS::itineraire(), plusCourtCheminElague() de
+//! \brief graphe.h avec les arcs implicites vers la destination), puis sa durée est recalculée par le Dijkstra à monceau
+//! \brief de graphe.cpp (RechercheGraphe, sur les arcs explicites vers la destination): les deux temps sont rapportés.
+//! \brief avec fichier_trace, le chargement, la construction du réseau et les requêtes y sont tracés (JSON « trace
+//! \brief event », à ouvrir avec chrome://tracing ou Perfetto)
+int main(int argc, char *argv[])
 {
+    string fichierTrace = argc > 1 ? argv[1] : "";
+    if (!fichierTrace.empty()) Trace::demarrer();
+
     const string chemin_dossier = "RTC-8aout-1dec";
     Date today(2017, 8, 18);
     Heure now1(8, 30, 0);
@@ -68,6 +79,7 @@ int main()
     bool afficherItineraire = true;
     const unsigned int nbDeTests = 100; //nombre de tests à effectuer
     long moy_tempsExecution = 0;
+    long moy_tempsExecutionMonceau = 0;
 
     for (unsigned int i = 0; i < nbDeTests; ++i)
     {
@@ -98,12 +110,29 @@ int main()
         cout << "Temps d'exécution de l'algorithme de plus court chemin: " << tempsExecution
              << " microsecondes" << endl;
 
+        reseau_rtc.expliciterArcsVersDestination(donnees_rtc);
+        auto debutMonceau = chrono::steady_clock::now();
+        reseau_rtc.dureeItineraire(ReseauGTFS::RechercheGraphe);
+        long tempsExecutionMonceau = chrono::duration_cast<chrono::microseconds>(
+                chrono::steady_clock::now() - debutMonceau).count();
+        moy_tempsExecutionMonceau += tempsExecutionMonceau;
+        cout << "Temps d'exécution de plusCourtChemin() de graphe.cpp (monceau): " << tempsExecutionMonceau
+             << " microsecondes" << endl;
+
         reseau_rtc.enleverArcsOrigineDestination();
 
     }
 
     cout << endl << "La moyenne du temps d'exécution sur " << nbDeTests << " itinéraires est de "
          << (double)moy_tempsExecution / (double)nbDeTests << " microsecondes" << endl;
+    cout << "La moyenne du temps d'exécution de plusCourtChemin() de graphe.cpp (monceau) est de "
+         << (double)moy_tempsExecutionMonceau / (double)nbDeTests << " microsecondes" << endl;
+
+    if (!fichierTrace.empty())
+    {
+        Trace::ecrireFichier(fichierTrace);
+        cout << "Trace écrite dans " << fichierTrace << endl;
+    }
 
     return 0;
 }
@@ -14,6 +14,7 @@
 #include "coordonnees.h"
 #include "arret.h"
 #include "auxiliaires.h"
+#include "arene.h"
 
 /*!
  * \class Station
@@ -24,7 +25,12 @@ class Station {
 
 
 public:
-    Station(unsigned int p_id, const std::string & p_nom, const std::string & p_description,const Coordonnees & p_coords);
+    //! \brief les arrêts par heure; leurs noeuds sont dans l'arène de l'objet DonneesGTFS qui a créé la station
+    typedef std::multimap<Heure, Arret::Ptr, std::less<Heure>,
+            AllocateurArene<std::pair<const Heure, Arret::Ptr> > > Arrets;
+
+    Station(unsigned int p_id, const std::string & p_nom, const std::string & p_description,const Coordonnees & p_coords,
+            const std::shared_ptr<Arene> & p_arene = std::shared_ptr<Arene>());
     Station();
     friend std::ostream& operator<<(std::ostream& flux, const Station& p_station);
 	const Coordonnees& getCoords() const;
@@ -32,15 +38,16 @@ public:
 	const std::string& getNom() const;
 	unsigned int getId() const;
     void addArret(const Arret::Ptr & p_arret);
+    void retirerArret(const Arret::Ptr & p_arret);
     unsigned int getNbArrets() const;
-    const std::multimap<Heure, Arret::Ptr> & getArrets() const;
+    const Arrets & getArrets() const;
 
 private:
     unsigned int m_id;
     std::string m_nom;
     std::string m_description;
     Coordonnees m_coords;
-    std::multimap<Heure, Arret::Ptr> m_arrets;
+    Arrets m_arrets;
 
 };
 
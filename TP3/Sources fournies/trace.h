@@ -0,0 +1,46 @@
+//
+// Traces d'exécution au format « trace event » (JSON) de Chrome, lisibles par chrome://tracing ou Perfetto
+//
+
+#ifndef RTC_TRACE_H
+#define RTC_TRACE_H
+
+#include <ostream>
+#include <string>
+#include <chrono>
+
+/*!
+ * \class Trace
+ * \brief Cette classe enregistre, sur demande, les intervalles de temps des étapes du chargement, de la construction
+ * \brief du réseau et des requêtes, par thread.
+ * \brief Désactivée (par défaut), un Intervalle ne coûte qu'une lecture d'un booléen atomique. Activée, chaque thread
+ * \brief ajoute ses intervalles à son propre tampon; ecrireJson() les écrit tous, chacun sur la ligne de son thread.
+ */
+class Trace
+{
+public:
+    //! \brief un intervalle de temps, de sa construction à sa destruction, enregistré si la trace est active
+    //! \brief p_nom et p_categorie doivent rester valides jusqu'à l'écriture de la trace (ex.: des littéraux)
+    class Intervalle
+    {
+    public:
+        explicit Intervalle(const char *p_nom, const char *p_categorie = "gtfs");
+        ~Intervalle();
+        Intervalle(const Intervalle &) = delete;
+        Intervalle &operator=(const Intervalle &) = delete;
+
+    private:
+        const char *m_nom; //nullptr si la trace n'était pas active à la construction
+        const char *m_categorie;
+        std::chrono::steady_clock::time_point m_debut;
+    };
+
+    static void demarrer();
+    static void arreter();
+    static bool estActive();
+    static void ecrireJson(std::ostream &);
+    static void ecrireFichier(const std::string &);
+    static void vider();
+};
+
+#endif //RTC_TRACE_H
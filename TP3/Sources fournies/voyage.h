@@ -11,6 +11,7 @@
 #include <memory>
 #include "arret.h"
 #include "auxiliaires.h"
+#include "arene.h"
 
 /*!
  * \class Voyage
@@ -26,9 +27,13 @@ public:
         bool operator() (Arret::Ptr i, Arret::Ptr j) const;
     };
 
-    Voyage(const std::string & p_id, unsigned int p_ligne_id, const std::string & p_service_id, const std::string & p_destination);
+    //! \brief les arrêts dans l'ordre du trajet; leurs noeuds sont dans l'arène de l'objet DonneesGTFS qui a créé le voyage
+    typedef std::set<Arret::Ptr, compArret, AllocateurArene<Arret::Ptr> > Arrets;
+
+    Voyage(const std::string & p_id, unsigned int p_ligne_id, const std::string & p_service_id, const std::string & p_destination,
+           const std::shared_ptr<Arene> & p_arene = std::shared_ptr<Arene>());
     Voyage();
-	const std::set<Arret::Ptr, compArret> & getArrets() const;
+	const Arrets & getArrets() const;
     unsigned int getNbArrets() const;
 	const std::string& getDestination() const;
 	std::string getId() const;
@@ -47,7 +52,7 @@ private:
 	unsigned int m_ligne;
 	std::string m_service_id;
 	std::string m_destination;
-	std::set<Arret::Ptr, compArret> m_arrets;
+	Arrets m_arrets;
 
 };
 